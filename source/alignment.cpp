@@ -111,11 +111,28 @@ alignment::alignment(void) {
   /* Information computed from alignment */
   sgaps =     NULL;
   scons =     NULL;
+  simMatrix = NULL;
   seqMatrix = NULL;
 
   identities = NULL;
   overlaps = NULL;
 
+  storedGaps = NULL;
+  storedIndets = NULL;
+  residueCodes = NULL;
+  columnCodes = NULL;
+  alphabetSize = 0;
+  sequenceMasks = NULL;
+  columnMasks = NULL;
+  uniqueSeqs = NULL;
+  uniqueRows = NULL;
+  uniqueNumber = 0;
+  uniqueCols = NULL;
+  uniqueColRows = NULL;
+  uniqueColNumber = 0;
+  sequenceWords = 0;
+  columnWords = 0;
+
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
 }
 
@@ -129,7 +146,7 @@ alignment::alignment(string o_filename, string o_aligInfo, string *o_sequences,
                      int o_left_boundary, int o_right_boundary,
                      bool o_keepSeqs, bool o_keepHeader, int OldSequences, int OldResidues, int *o_residuesNumber,
                      int *o_saveResidues, int *o_saveSequences, int o_ghWindow, int o_shWindow, int o_blockSize,
-                     float **o_identities, float **o_overlaps) {
+                     identityMatrix *o_identities, float **o_overlaps) {
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
   int i, j, k, ll;
@@ -227,13 +244,12 @@ alignment::alignment(string o_filename, string o_aligInfo, string *o_sequences,
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
   identities = NULL;
   if(o_identities != NULL) {
-    identities = new float*[sequenNumber];
+    identities = new identityMatrix(sequenNumber, 1);
     for(i = 0, j = 0; i < OldSequences; i++) {
       if(o_saveSequences[i] != -1) {
-        identities[j] = new float[sequenNumber];
-        for(k = 0, ll = 0; k < OldSequences; k++) {
+        for(k = i + 1, ll = j + 1; k < OldSequences; k++) {
           if(o_saveSequences[k] != -1) {
-            identities[j][ll] = o_identities[i][k];
+            identities -> set(j, ll, o_identities -> get(i, k));
             ll++;
           }
         }
@@ -266,8 +282,26 @@ alignment::alignment(string o_filename, string o_aligInfo, string *o_sequences,
    * if it will be necessary, has to be computed */
   sgaps  =     NULL;
   scons  =     NULL;
+  simMatrix =  NULL;
   seqMatrix =  NULL;
+  delete identities;
   identities = NULL;
+
+  storedGaps = NULL;
+  storedIndets = NULL;
+  residueCodes = NULL;
+  columnCodes = NULL;
+  alphabetSize = 0;
+  sequenceMasks = NULL;
+  columnMasks = NULL;
+  uniqueSeqs = NULL;
+  uniqueRows = NULL;
+  uniqueNumber = 0;
+  uniqueCols = NULL;
+  uniqueColRows = NULL;
+  uniqueColNumber = 0;
+  sequenceWords = 0;
+  columnWords = 0;
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
 }
 
@@ -361,14 +395,9 @@ alignment &alignment::operator=(const alignment &old) {
     /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
     /* ***** ***** ***** ***** ***** ***** ***** ***** */
-    delete [] identities;
+    delete identities;
     if(old.identities) {
-      identities = new float*[sequenNumber];
-      for(i = 0; i < sequenNumber; i++) {
-        identities[i] = new float[sequenNumber];
-        for(j = 0; j < sequenNumber; j++)
-          identities[i][j] = old.identities[i][j];
-      }
+      identities = new identityMatrix(*old.identities);
     } else identities = NULL;
     /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
@@ -390,6 +419,31 @@ alignment &alignment::operator=(const alignment &old) {
 
     delete scons;
     scons = NULL;
+    simMatrix = NULL;
+
+    delete [] storedGaps;
+    delete [] storedIndets;
+    storedGaps = NULL;
+    storedIndets = NULL;
+    delete [] residueCodes;
+    delete [] columnCodes;
+    residueCodes = NULL;
+    columnCodes = NULL;
+    alphabetSize = 0;
+    delete [] sequenceMasks;
+    delete [] columnMasks;
+    sequenceMasks = NULL;
+    columnMasks = NULL;
+    delete [] uniqueSeqs;
+    delete [] uniqueRows;
+    uniqueSeqs = NULL;
+    uniqueRows = NULL;
+    uniqueNumber = 0;
+    delete [] uniqueCols;
+    delete [] uniqueColRows;
+    uniqueCols = NULL;
+    uniqueColRows = NULL;
+    uniqueColNumber = 0;
 
     delete seqMatrix;
     seqMatrix = old.seqMatrix;
@@ -437,11 +491,7 @@ alignment::~alignment(void) {
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
-  if(identities != NULL) {
-    for(i = 0; i < sequenNumber; i++)
-      delete [] identities[i];
-    delete [] identities;
-  }
+  delete identities;
   identities = NULL;
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
@@ -462,10 +512,37 @@ alignment::~alignment(void) {
   if(scons != NULL)
     delete scons;
   scons = NULL;
+  simMatrix = NULL;
 
   if(seqMatrix != NULL)
     delete seqMatrix;
   seqMatrix = NULL;
+
+  delete [] storedGaps;
+  delete [] storedIndets;
+  storedGaps = NULL;
+  storedIndets = NULL;
+  delete [] residueCodes;
+  delete [] columnCodes;
+  delete [] sequenceMasks;
+  delete [] columnMasks;
+  delete [] uniqueSeqs;
+  delete [] uniqueRows;
+  delete [] uniqueCols;
+  delete [] uniqueColRows;
+  residueCodes = NULL;
+  columnCodes = NULL;
+  alphabetSize = 0;
+  sequenceMasks = NULL;
+  columnMasks = NULL;
+  uniqueSeqs = NULL;
+  uniqueRows = NULL;
+  uniqueNumber = 0;
+  uniqueCols = NULL;
+  uniqueColRows = NULL;
+  uniqueColNumber = 0;
+  sequenceWords = 0;
+  columnWords = 0;
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
@@ -500,8 +577,16 @@ alignment::~alignment(void) {
 // Try to load current alignment and inform otherwise
 bool alignment::loadAlignment(char *alignmentFile) {
 
+  lineReader file;
+  mappedFile input;
+
+  // Input file is opened just once. Format detection and the parser share
+  // the same buffered data
+  if(!file.open(alignmentFile))
+    return false;
+
   // Detect input alignment format - it is an strict detection procedure
-  iformat = formatInputAlignment(alignmentFile);
+  iformat = formatInputAlignment(file);
   // Unless it is indicated somewhere else, output alignment format will be
   // the same as the input one
   oformat = iformat;
@@ -509,21 +594,40 @@ bool alignment::loadAlignment(char *alignmentFile) {
   // Use the appropiate function to read input alignment
   switch(iformat) {
     case 1:
-      return loadClustalAlignment(alignmentFile);
+      return loadClustalAlignment(alignmentFile, file);
     case 3:
-      return loadNBRF_PirAlignment(alignmentFile);
+      return loadNBRF_PirAlignment(alignmentFile, file);
     case 8:
-      return loadFastaAlignment(alignmentFile);
+      // Uncompressed FASTA files are parsed directly from a memory mapping
+      // of the already open file when it is possible. Otherwise, use the
+      // stream-based parser
+      if((file.getCompression() == PLAINFILE) &&
+        (input.open(file.getDescriptor())))
+        return loadFastaAlignment(alignmentFile, input);
+      return loadFastaAlignment(alignmentFile, file);
     case 11:
-      return loadPhylip3_2Alignment(alignmentFile);
+      return loadPhylip3_2Alignment(alignmentFile, file);
     case 12:
-      return loadPhylipAlignment(alignmentFile);
+      // Uncompressed interleaved PHYLIP files are parsed in parallel from a
+      // memory mapping as well
+      if((file.getCompression() == PLAINFILE) &&
+        (input.open(file.getDescriptor())))
+        return loadPhylipAlignment(alignmentFile, input);
+      return loadPhylipAlignment(alignmentFile, file);
     case 17:
-      return loadNexusAlignment(alignmentFile);
+      return loadNexusAlignment(alignmentFile, file);
     case 21:
-      return loadMegaInterleavedAlignment(alignmentFile);
+      return loadMegaInterleavedAlignment(alignmentFile, file);
     case 22:
-      return loadMegaNonInterleavedAlignment(alignmentFile);
+      return loadMegaNonInterleavedAlignment(alignmentFile, file);
+    case 30:
+      // Binary alignments are always loaded from a memory mapping
+      if((file.getCompression() == PLAINFILE) &&
+        (input.open(file.getDescriptor())))
+        return loadBinaryAlignment(alignmentFile, input);
+      cerr << endl << "ERROR: Binary alignments can not be read from "
+        << "compressed files or pipes." << endl;
+      return false;
   // Return a FALSE value - meaning the input alignment was not loaded
     default:
       return false;
@@ -590,6 +694,9 @@ bool alignment::printAlignment(void){
     case 21: case 22:
       alignmentMegaToFile(cout);
       break;
+    case 30:
+      alignmentBinaryToFile(cout);
+      break;
     case 99:
       getSequences(cout);
       break;
@@ -608,7 +715,7 @@ bool alignment::printAlignment(void){
 /* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
 bool alignment::saveAlignment(char *destFile) {
 
-  ofstream file;
+  outputFile file;
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
   if(sequences == NULL)
     return false;
@@ -634,9 +741,9 @@ bool alignment::saveAlignment(char *destFile) {
   }
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
-  /* File open and correct open check */
-  file.open(destFile);
-  if(!file) return false;
+  /* File open and correct open check. Output file is compressed
+   * depending on its extension */
+  if(!file.open(destFile)) return false;
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
@@ -667,6 +774,9 @@ bool alignment::saveAlignment(char *destFile) {
     case 21: case 22:
       alignmentMegaToFile(file);
       break;
+    case 30:
+      alignmentBinaryToFile(file);
+      break;
     case 99:
       getSequences(file);
       break;
@@ -679,12 +789,8 @@ bool alignment::saveAlignment(char *destFile) {
   }
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
-  /* Close the output file */
-  file.close();
-
-  /* ***** ***** ***** ***** ***** ***** ***** ***** */
-  /* All is OK, return true */
-  return true;
+  /* Close the output file and check everything has been written */
+  return file.close();
 }
 
 /* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
@@ -766,7 +872,7 @@ alignment *alignment::cleanConservation(float baseLine, float conservationPct, b
   /* Once we have the cut value, we call the appropiate
    * method to clean the alignment and, then, generate
      the new alignment */
-  ret = cleanByCutValue(cut, baseLine, scons -> getMdkwVector(), complementary);
+  ret = cleanByCutValue(cut, baseLine, scons -> getMdkwVector(cut), complementary);
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
@@ -983,8 +1089,8 @@ alignment *alignment::clean2ndSlope(bool complementarity) {
 /* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
 alignment *alignment::cleanCombMethods(bool complementarity, bool variable) {
 
-  float simCut, first20Point, last80Point, *simil, *vectAux;
-  int i, j, acm, gapCut, *positions, *gaps;
+  float simCut, first20Point, last80Point;
+  int i, j, acm, gapCut, first20, last80, *positions, *gaps;
   double inic, fin, vlr;
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
@@ -1007,57 +1113,32 @@ alignment *alignment::cleanCombMethods(bool complementarity, bool variable) {
    * we calculate them */
   if(calculateConservationStats() != true)
     return NULL;
-
-  // Once the conservation stats have been calculated, generate the vector
-  // containing the similarity value for each column considering parameters
-  // such as windows size
-  simil = scons -> getMdkwVector();
-  /* ***** ***** ***** ***** ***** ***** ***** ***** */
-
-  /* ***** ***** ***** ***** ***** ***** ***** ***** */
-  /* Allocate local memory and initializate it to -1 */
-  positions = new int[residNumber];
-  utils::initlVect(positions, residNumber, -1);
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
   /* The method only selects columns with gaps number
    * less or equal than the gap's cut point. Counts the
    * number of columns that have been selected */
-  for(i = 0, acm = 0; i < residNumber; i++) {
-    if(gaps[i] <= gapCut) {
-      positions[i] = i;
-      acm++;
-    }
-  }
-  /* ***** ***** ***** ***** ***** ***** ***** ***** */
-
-  /* ***** ***** ***** ***** ***** ***** ***** ***** */
-  /* Allocate local memory and save the similaritys
-   * values for the columns that have been selected */
-  vectAux = new float[acm];
-  for(i = 0, j = 0; i < residNumber; i++)
-    if(positions[i] != -1)
-      vectAux[j++] = simil[i];
-  /* ***** ***** ***** ***** ***** ***** ***** ***** */
-
-  /* ***** ***** ***** ***** ***** ***** ***** ***** */
-  /* Sort the conservation's value vector. */
-  utils::quicksort(vectAux, 0, acm-1);
-
-  /* ...and search for the vector points at the 20 and
-   * 80% of length. */
-  first20Point = 0;
-  last80Point  = 0;
+  positions = new int[residNumber];
+  for(i = 0, acm = 0; i < residNumber; i++)
+    if(gaps[i] <= gapCut)
+      positions[acm++] = i;
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
-  for(i = acm - 1, j = 1; i >= 0; i--, j++) {
+  /* Search for the points at the 20 and 80% of length
+   * of the sorted conservation's values, counting from
+   * the highest one. Only those two values are asked
+   * for, so not every column has to be computed */
+  for(j = 1, first20 = 0, last80 = 0; j <= acm; j++) {
     if((((float) j/acm) * 100.0) <= 20.0)
-      first20Point = vectAux[i];
+      first20 = j;
     if((((float) j/acm) * 100.0) <= 80.0)
-      last80Point = vectAux[i];
+      last80 = j;
   }
+
+  first20Point = (first20 > 0) ? scons -> getMdkwValue(positions, acm, acm - first20) : 0;
+  last80Point  = (last80 > 0) ? scons -> getMdkwValue(positions, acm, acm - last80) : 0;
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
@@ -1075,12 +1156,11 @@ alignment *alignment::cleanCombMethods(bool complementarity, bool variable) {
    * object using the gaps cut and the similaritys cut
    *  values */
   alignment *ret = cleanStrict(gapCut, sgaps -> getGapsWindow(),
-        simCut, scons -> getMdkwVector(), complementarity, variable);
+        simCut, scons -> getMdkwVector(simCut), complementarity, variable);
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
   /* Deallocate local memory */
-  delete [] vectAux;
   delete [] positions;
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
@@ -1129,9 +1209,11 @@ alignment *alignment::cleanNoAllGaps(bool complementarity) {
 /* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
 bool alignment::calculateSpuriousVector(float overlap, float *spuriousVector) {
 
-  int i, j, k, seqValue, ovrlap, hit;
+  int i, j, seqValue, ovrlap, uniques, *hits;
+  const int *unique, *rows;
+  const uint64_t *valid, *gaps;
+  const unsigned char *codes;
   float floatOverlap;
-  char indet;
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
   /* Compute the overlap */
@@ -1149,73 +1231,51 @@ bool alignment::calculateSpuriousVector(float overlap, float *spuriousVector) {
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
-  /* Depending on the kind of alignment, we have
-   * different indetermination symbol */
-  if(getTypeAlignment() == AAType)
-    indet = 'X';
-  else
-    indet = 'N';
+  /* A position counts as a hit against other sequence
+   * when both have the same element or both have a
+   * valid residue. So, the hits of a position only
+   * depend on whether it is a gap, an indetermination
+   * or a valid residue, and on how many of them there
+   * are in its column. Count them from the columns
+   * bit masks, indexing by the lowest residue codes */
+  if((codes = getResidueCodes()) == NULL)
+    return false;
+  valid = getColumnMasks(false);
+  gaps = getColumnMasks(true);
+
+  hits = new int[3 * residNumber];
+  for(j = 0; j < residNumber; j++) {
+    hits[3 * j + GAPCODE] = utils::countBits(gaps, columnWords);
+    hits[3 * j + INDETCODE + 1] = utils::countBits(valid, columnWords);
+    hits[3 * j + INDETCODE] = sequenNumber - hits[3 * j + GAPCODE] -
+      hits[3 * j + INDETCODE + 1];
+    valid += columnWords;
+    gaps += columnWords;
+  }
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
-  /* For each alignment's sequence, computes its overlap */
+  /* For each alignment's sequence, computes its overlap.
+   * Identical sequences get the value of their first
+   * copy */
+  unique = getUniqueSequences(uniques, rows);
   for(i = 0, seqValue = 0; i < sequenNumber; i++, seqValue = 0) {
 
-    /* ***** ***** ***** ***** ***** ***** ***** ***** */
-    /* For each alignment's column, computes the overlap
-     * between the selected sequence and the other ones */
-    for(j = 0; j < residNumber; j++) {
-
-      /* ***** ***** ***** ***** ***** ***** ***** ***** */
-      /* For sequences are before the sequence selected */
-      for(k = 0, hit = 0; k < i; k++) {
-
-        /* ***** ***** ***** ***** ***** ***** ***** ***** */
-        /* If the element of sequence selected is the same
-         * that the element of sequence considered, computes
-         * a hit */
-        if(sequences[i][j] == sequences[k][j])
-          hit++;
-
-        /* If the element of sequence selected isn't a 'X' nor
-         * 'N' (indetermination) or a '-' (gap) and the element
-         * of sequence considered isn't a  a 'X' nor 'N'
-         * (indetermination) or a '-' (gap), computes a hit */
-        else if((sequences[i][j] != indet) && (sequences[i][j] != '-')
-          && (sequences[k][j] != indet) && (sequences[k][j] != '-'))
-          hit++;
-      }
-      /* ***** ***** ***** ***** ***** ***** ***** ***** */
-
-      /* ***** ***** ***** ***** ***** ***** ***** ***** */
-      /* For sequences are after the sequence selected */
-      for(k = (i + 1); k < sequenNumber; k++) {
-
-        /* ***** ***** ***** ***** ***** ***** ***** ***** */
-        /* If the element of sequence selected is the same
-         * that the element of sequence considered, computes
-         * a hit */
-        if(sequences[i][j] == sequences[k][j])
-          hit++;
-
-        /* If the element of sequence selected isn't a 'X' nor
-         * 'N' (indetermination) or a '-' (gap) and the element
-         * of sequence considered isn't a  a 'X' nor 'N'
-         * (indetermination) or a '-' (gap), computes a hit */
-        else if((sequences[i][j] != indet) && (sequences[i][j] != '-')
-          && (sequences[k][j] != indet) && (sequences[k][j] != '-'))
-          hit++;
-      }
-      /* ***** ***** ***** ***** ***** ***** ***** ***** */
+    if((unique != NULL) && (rows[2 * unique[i]] != i)) {
+      spuriousVector[i] = spuriousVector[rows[2 * unique[i]]];
+      codes += residNumber;
+      continue;
+    }
 
-      /* ***** ***** ***** ***** ***** ***** ***** ***** */
-      /* Finally, if the hit's number divided by number of
-       * sequences minus one is greater or equal than
-       * overlap's value, computes a column's hit. */
-      if(hit >= ovrlap)
+    /* ***** ***** ***** ***** ***** ***** ***** ***** */
+    /* For each alignment's column, if the hits' number,
+     * excluding the sequence itself, divided by number
+     * of sequences minus one is greater or equal than
+     * overlap's value, computes a column's hit. */
+    for(j = 0; j < residNumber; j++, codes++)
+      if(hits[3 * j + utils::min((int) *codes, INDETCODE + 1)] - 1 >= ovrlap)
         seqValue++;
-      /* ***** ***** ***** ***** ***** ***** ***** ***** */
-    }
+    /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
     /* ***** ***** ***** ***** ***** ***** ***** ***** */
     /* For each alignment's sequence, computes its spurious's
@@ -1224,6 +1284,8 @@ bool alignment::calculateSpuriousVector(float overlap, float *spuriousVector) {
     spuriousVector[i] = ((float) seqValue / residNumber);
     /* ***** ***** ***** ***** ***** ***** ***** ***** */
   }
+  delete [] hits;
+  /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
   /* If there is not problem in the method, return true */
@@ -1248,7 +1310,7 @@ int *alignment::calculateRepresentativeSeq(float maximumIdent) {
 
   int i, j, pos, clusterNum, **seqs;
   int *cluster;
-  static int *repres;
+  int *repres;
   float max;
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
@@ -1279,9 +1341,9 @@ int *alignment::calculateRepresentativeSeq(float maximumIdent) {
 
     /* ***** ***** ***** ***** ***** ***** ***** ***** */
     for(j = 0, max = 0, pos = -1; j < clusterNum; j++) {
-      if(identities[seqs[i][1]][cluster[j]] > maximumIdent) {
-        if(identities[seqs[i][1]][cluster[j]] > max) {
-          max = identities[seqs[i][1]][cluster[j]];
+      if(identities -> get(seqs[i][1], cluster[j]) > maximumIdent) {
+        if(identities -> get(seqs[i][1], cluster[j]) > max) {
+          max = identities -> get(seqs[i][1], cluster[j]);
           pos = j;
         }
       }
@@ -1349,20 +1411,20 @@ float alignment::getCutPointClusters(int clusterNumber) {
   for(i = 0,gMax = 0, gMin = 1, startingPoint = 0; i < sequenNumber; i++) {
     /* ***** ***** ***** ***** ***** ***** ***** ***** */
     for(j = 0, max = 0, avg = 0, min = 1; j < i; j++) {
-      if(max < identities[i][j])
-        max  = identities[i][j];
-      if(min > identities[i][j])
-        min  = identities[i][j];
-      avg += identities[i][j];
+      if(max < identities -> get(i, j))
+        max  = identities -> get(i, j);
+      if(min > identities -> get(i, j))
+        min  = identities -> get(i, j);
+      avg += identities -> get(i, j);
     }
     /* ***** ***** ***** ***** ***** ***** ***** ***** */
     /* ***** ***** ***** ***** ***** ***** ***** ***** */
     for(j = i + 1; j < sequenNumber; j++) {
-      if(max < identities[i][j])
-        max  = identities[i][j];
-      if(min > identities[i][j])
-        min  = identities[i][j];
-      avg += identities[i][j];
+      if(max < identities -> get(i, j))
+        max  = identities -> get(i, j);
+      if(min > identities -> get(i, j))
+        min  = identities -> get(i, j);
+      avg += identities -> get(i, j);
     }
     /* ***** ***** ***** ***** ***** ***** ***** ***** */
     startingPoint += avg / (sequenNumber - 1);
@@ -1412,7 +1474,7 @@ float alignment::getCutPointClusters(int clusterNumber) {
     for(i = sequenNumber - 2; i >= 0; i--) {
       /* ***** ***** ***** ***** ***** ***** ***** ***** */
       for(j = 0; j < clusterNum; j++)
-        if(identities[seqs[i][1]][cluster[j]] > startingPoint)
+        if(identities -> get(seqs[i][1], cluster[j]) > startingPoint)
           break;
       /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
@@ -1650,6 +1712,9 @@ alignment *alignment::getTranslationCDS(int newResidues, int newSequences, int *
 /* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
 bool alignment::calculateGapStats(void) {
 
+  const uint64_t *valid, *gap;
+  int i, *counts;
+
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
   /* If alignment matrix is not created, return false */
   if(sequences == NULL)
@@ -1660,7 +1725,29 @@ bool alignment::calculateGapStats(void) {
   /* If sgaps object is not created, we create them
      and calculate the statistics */
   if(sgaps == NULL) {
-    sgaps = new statisticsGaps(sequences, sequenNumber, residNumber, dataType);
+    /* Use gaps counts loaded from a binary alignment when available */
+    if(storedGaps != NULL)
+      sgaps = new statisticsGaps(storedGaps, storedIndets, sequenNumber,
+        residNumber, dataType);
+    else {
+      /* Count gaps and indeterminations per column from its bit masks. Any
+       * position being neither a gap nor a valid residue is an indetermination */
+      if((valid = getColumnMasks(false)) == NULL)
+        return false;
+      gap = getColumnMasks(true);
+
+      counts = new int[2 * residNumber];
+      for(i = 0; i < residNumber; i++) {
+        counts[i] = utils::countBits(gap, columnWords);
+        counts[residNumber + i] = sequenNumber - counts[i] -
+          utils::countBits(valid, columnWords);
+        valid += columnWords;
+        gap += columnWords;
+      }
+      sgaps = new statisticsGaps(counts, counts + residNumber, sequenNumber,
+        residNumber, getTypeAlignment());
+      delete [] counts;
+    }
     sgaps -> applyWindow(ghWindow);
   }
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
@@ -1703,16 +1790,20 @@ void alignment::printStatisticsGapsTotal(void) {
 bool alignment::setSimilarityMatrix(similarityMatrix *sm) {
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
-  /* If scons object is not created, we create them */
-  if(scons == NULL)
-    scons = new statisticsConservation(sequences, sequenNumber, residNumber, dataType);
+  /* A similarity matrix should be provided */
+  if(sm == NULL)
+    return false;
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
-  /* Associate the matrix to the similarity statistics
-   * object */
-  if(!scons -> setSimilarityMatrix(sm))
-    return false;
+  /* Keep the matrix until the conservation statistics
+   * are asked for. Statistics computed with another
+   * matrix are not valid anymore */
+  if(sm != simMatrix) {
+    delete scons;
+    scons = NULL;
+    simMatrix = sm;
+  }
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
@@ -1727,6 +1818,10 @@ bool alignment::setSimilarityMatrix(similarityMatrix *sm) {
 /* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
 bool alignment::calculateConservationStats(void) {
 
+  const unsigned char *codes;
+  const int *unique, *rows, *uniqueColumns, *columnRows;
+  int uniques, columns;
+
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
   /* It the gaps statistics object has not been created
    * we create it */
@@ -1734,24 +1829,34 @@ bool alignment::calculateConservationStats(void) {
     return false;
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
-  /* ***** ***** ***** ***** ***** ***** ***** ***** */
-  /* It the similarity statistics object has not been
-   * created we create it */
-  if(scons == NULL)
-    return false;
-  /* ***** ***** ***** ***** ***** ***** ***** ***** */
-
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
   /* Ask for the similarity matrix */
-  if(scons -> isSimMatrixDef() != true)
+  if(simMatrix == NULL)
     return false;
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
-  /* Compute the similarity statistics from the input
-   * alignment */
-  if(!scons -> calculateVectors(sequences, sgaps->getGapsWindow()))
-    return false;
+  /* It the similarity statistics object has not been
+   * created we create it and compute the similarity
+   * statistics from the input alignment. Sequences
+   * identities are computed at this point, if they
+   * have not been computed before */
+  if(scons == NULL) {
+    scons = new statisticsConservation(getSeqIdentities(), sequenNumber,
+      residNumber, getTypeAlignment());
+    scons -> setSimilarityMatrix(simMatrix);
+
+    /* Codes are built before passing their alphabet */
+    codes = getColumnCodes();
+    unique = getUniqueSequences(uniques, rows);
+    uniqueColumns = getUniqueColumns(columns, columnRows);
+    if(!scons -> calculateVectors(codes, alphabet, alphabetSize,
+      sgaps->getGapsWindow(), unique, uniques, uniqueColumns, columnRows)) {
+      delete scons;
+      scons = NULL;
+      return false;
+    }
+  }
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
   /* Ask to know if it is necessary to apply any window
@@ -1840,6 +1945,19 @@ void alignment::trimTerminalGaps(bool terminalOnly_, int *boundaries_) {
 /* This method stores the diferent windows values in the alignment object */
 /* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
 void alignment::setWindowsSize(int ghWindow_, int shWindow_) {
+  /* Statistics computed with other windows are not valid anymore. Gaps
+   * statistics are used by the conservation ones as well */
+  if(ghWindow_ != ghWindow) {
+    delete sgaps;
+    sgaps = NULL;
+    delete scons;
+    scons = NULL;
+  }
+  if(shWindow_ != shWindow) {
+    delete scons;
+    scons = NULL;
+  }
+
   ghWindow = ghWindow_;
   shWindow = shWindow_;
 }
@@ -1880,6 +1998,14 @@ void alignment::setReverse(void) {
   reverse = true;
 }
 
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+/* This method lets to write residues either in upper or lower case */
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+void alignment::setCase(bool upper) {
+  upperCase = upper;
+  lowerCase = !upper;
+}
+
 
 /* Set appropiate flag to decide whether sequences composed only by gaps should
  * be kept or not */
@@ -2031,6 +2157,276 @@ int alignment::getTypeAlignment(void) {
   return dataType;
 }
 
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+/* Returns alignment residues encoded as small integer codes in a single block,
+ * sequence by sequence. Gaps and indeterminations have their own codes,
+ * GAPCODE and INDETCODE, and any other symbol gets the next free code when it
+ * is found for first time, so codes are dense and a protein alignment fits in
+ * 5 bits and a nucleotide one in 4 bits. Codes are only available for aligned
+ * sequences and they are built the first time they are requested */
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+const unsigned char *alignment::getResidueCodes(void) {
+  int i, j, codes[256];
+  unsigned char *row;
+  const char *residues;
+  char indet;
+
+  if(residueCodes != NULL)
+    return residueCodes;
+
+  if((sequences == NULL) || (!isAligned))
+    return NULL;
+
+  /* Depending on alignment type, indetermination symbol will be one or other */
+  indet = getTypeAlignment() == AAType ? 'X' : 'N';
+
+  for(i = 0; i < 256; i++)
+    codes[i] = -1;
+  codes[(unsigned char) '-'] = GAPCODE;
+  codes[(unsigned char) indet] = INDETCODE;
+  alphabet[GAPCODE] = '-';
+  alphabet[INDETCODE] = indet;
+  alphabetSize = INDETCODE + 1;
+
+  residueCodes = new unsigned char[(size_t) sequenNumber * residNumber];
+
+  for(i = 0, row = residueCodes; i < sequenNumber; i++, row += residNumber) {
+    residues = sequences[i].data();
+    for(j = 0; j < residNumber; j++) {
+      if(codes[(unsigned char) residues[j]] == -1) {
+        codes[(unsigned char) residues[j]] = alphabetSize;
+        alphabet[alphabetSize++] = residues[j];
+      }
+      row[j] = (unsigned char) codes[(unsigned char) residues[j]];
+    }
+  }
+  return residueCodes;
+}
+
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+/* Returns the residues codes stored column by column in a single block: the
+ * code of the j-th sequence at the i-th column is at i * sequenNumber + j.
+ * It is built the first time it is requested */
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+const unsigned char *alignment::getColumnCodes(void) {
+  int i, j, k, l, rows, cols;
+  const unsigned char *codes, *row;
+  unsigned char *column;
+
+  if(columnCodes != NULL)
+    return columnCodes;
+
+  if((codes = getResidueCodes()) == NULL)
+    return NULL;
+
+  columnCodes = new unsigned char[(size_t) sequenNumber * residNumber];
+
+  /* Transpose the alignment by square tiles. Each tile reads a few residues
+   * from a set of sequences and writes them into a set of columns, so both
+   * sides of the copy stay in cache while the tile is processed */
+  for(i = 0; i < sequenNumber; i += TRANSPOSEBLOCK) {
+    rows = utils::min(TRANSPOSEBLOCK, sequenNumber - i);
+    for(j = 0; j < residNumber; j += TRANSPOSEBLOCK) {
+      cols = utils::min(TRANSPOSEBLOCK, residNumber - j);
+      for(k = 0; k < rows; k++) {
+        row = codes + (size_t) (i + k) * residNumber + j;
+        column = columnCodes + (size_t) j * sequenNumber + i + k;
+        for(l = 0; l < cols; l++)
+          column[(size_t) l * sequenNumber] = row[l];
+      }
+    }
+  }
+  return columnCodes;
+}
+
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+/* Returns the residue corresponding to each code and the number of codes */
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+const char *alignment::getAlphabet(int &size) {
+  getResidueCodes();
+  size = alphabetSize;
+  return alphabet;
+}
+
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+/* Returns, sequence by sequence, the bit mask of either valid residues or
+ * gaps. Each sequence uses (residNumber + 63) / 64 words and the bit of a
+ * column is at word column / 64, bit column % 64. Masks of valid residues
+ * come first and masks of gaps follow them */
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+const uint64_t *alignment::getSequenceMasks(bool gaps) {
+  int i, j, words;
+  const unsigned char *codes;
+  uint64_t *valid, *gap;
+
+  if(sequenceMasks == NULL) {
+    if((codes = getResidueCodes()) == NULL)
+      return NULL;
+
+    sequenceWords = (residNumber + 63) / 64;
+    words = sequenNumber * sequenceWords;
+    sequenceMasks = new uint64_t[2 * (size_t) words];
+    memset(sequenceMasks, 0, sizeof(uint64_t) * 2 * (size_t) words);
+
+    for(i = 0; i < sequenNumber; i++, codes += residNumber) {
+      valid = sequenceMasks + (size_t) i * sequenceWords;
+      gap = valid + words;
+      for(j = 0; j < residNumber; j++) {
+        valid[j >> 6] |= (uint64_t) (codes[j] > INDETCODE) << (j & 63);
+        gap[j >> 6] |= (uint64_t) (codes[j] == GAPCODE) << (j & 63);
+      }
+    }
+  }
+  return sequenceMasks + (gaps ? (size_t) sequenNumber * sequenceWords : 0);
+}
+
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+/* Returns, column by column, the bit mask of either valid residues or gaps.
+ * Each column uses (sequenNumber + 63) / 64 words and the bit of a sequence
+ * is at word sequence / 64, bit sequence % 64 */
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+const uint64_t *alignment::getColumnMasks(bool gaps) {
+  int i, j, words;
+  const unsigned char *codes;
+  uint64_t *valid, *gap;
+
+  if(columnMasks == NULL) {
+    if((codes = getColumnCodes()) == NULL)
+      return NULL;
+
+    columnWords = (sequenNumber + 63) / 64;
+    words = residNumber * columnWords;
+    columnMasks = new uint64_t[2 * (size_t) words];
+    memset(columnMasks, 0, sizeof(uint64_t) * 2 * (size_t) words);
+
+    for(i = 0; i < residNumber; i++, codes += sequenNumber) {
+      valid = columnMasks + (size_t) i * columnWords;
+      gap = valid + words;
+      for(j = 0; j < sequenNumber; j++) {
+        valid[j >> 6] |= (uint64_t) (codes[j] > INDETCODE) << (j & 63);
+        gap[j >> 6] |= (uint64_t) (codes[j] == GAPCODE) << (j & 63);
+      }
+    }
+  }
+  return columnMasks + (gaps ? (size_t) residNumber * columnWords : 0);
+}
+
+static int groupRows(const unsigned char *codes, int rows, int length,
+  int *group, int *first) {
+  /* Group identical rows of a block of codes, numbering groups as their first
+   * rows appear. It gives the group of each row and the first and second rows
+   * of each group, -1 without a second one, and returns the number of groups.
+   * Rows are hashed a word at a time and looked up in an open addressing
+   * table, comparing the codes of those with the same hash */
+  int i, j, k, size, groups, *table;
+  const unsigned char *row;
+  uint64_t word, *hashes;
+
+  for(size = 1; size < 2 * rows; size <<= 1) ;
+  table = new int[size];
+  for(k = 0; k < size; k++)
+    table[k] = -1;
+  hashes = new uint64_t[rows];
+
+  for(i = 0, groups = 0, row = codes; i < rows; i++, row += length) {
+    for(j = 0, hashes[i] = 14695981039346656037ULL; j < length; j += 8) {
+      word = 0;
+      memcpy(&word, row + j, utils::min(8, length - j));
+      hashes[i] = (hashes[i] ^ word) * 1099511628211ULL;
+    }
+    hashes[i] ^= hashes[i] >> 32;
+
+    for(k = (int) (hashes[i] & (size - 1)); table[k] != -1; k = (k + 1) & (size - 1))
+      if((hashes[first[2 * table[k]]] == hashes[i]) &&
+         (!memcmp(codes + (size_t) first[2 * table[k]] * length, row, length)))
+        break;
+
+    if(table[k] == -1) {
+      table[k] = groups;
+      first[2 * groups] = i;
+      first[2 * groups + 1] = -1;
+      groups++;
+    }
+    else if(first[2 * table[k] + 1] == -1)
+      first[2 * table[k] + 1] = i;
+    group[i] = table[k];
+  }
+
+  delete [] table;
+  delete [] hashes;
+  return groups;
+}
+
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+/* Returns the unique sequence of each sequence, being identical sequences
+ * those with the same residues codes. Unique sequences are numbered as they
+ * appear for first time and, for each one, the positions of its first and
+ * second copies, or -1 without a second copy, are given as well. NULL is
+ * returned when every sequence is unique. It is built the first time it is
+ * requested */
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+const int *alignment::getUniqueSequences(int &count, const int *&rows) {
+  const unsigned char *codes;
+
+  if((uniqueNumber == 0) && ((codes = getResidueCodes()) != NULL)) {
+    uniqueSeqs = new int[sequenNumber];
+    uniqueRows = new int[2 * sequenNumber];
+    uniqueNumber = groupRows(codes, sequenNumber, residNumber, uniqueSeqs,
+      uniqueRows);
+
+    if(uniqueNumber == sequenNumber) {
+      delete [] uniqueSeqs;
+      delete [] uniqueRows;
+      uniqueSeqs = NULL;
+      uniqueRows = NULL;
+    }
+  }
+
+  count = (uniqueNumber == 0) ? sequenNumber : uniqueNumber;
+  rows = uniqueRows;
+  return uniqueSeqs;
+}
+
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+/* Returns the unique column of each column, being identical columns those
+ * with the same residues codes, and the positions of the first and second
+ * copies of each unique column, as it is done for sequences. NULL is
+ * returned when every column is unique. It is built the first time it is
+ * requested */
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+const int *alignment::getUniqueColumns(int &count, const int *&rows) {
+  const unsigned char *codes;
+
+  if((uniqueColNumber == 0) && ((codes = getColumnCodes()) != NULL)) {
+    uniqueCols = new int[residNumber];
+    uniqueColRows = new int[2 * residNumber];
+    uniqueColNumber = groupRows(codes, residNumber, sequenNumber, uniqueCols,
+      uniqueColRows);
+
+    if(uniqueColNumber == residNumber) {
+      delete [] uniqueCols;
+      delete [] uniqueColRows;
+      uniqueCols = NULL;
+      uniqueColRows = NULL;
+    }
+  }
+
+  count = (uniqueColNumber == 0) ? residNumber : uniqueColNumber;
+  rows = uniqueColRows;
+  return uniqueCols;
+}
+
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+/* Returns the identities between every pair of sequences. They are computed
+ * only once, the first time they are asked for, and shared by every method
+ * using them, e.g. the conservation statistics */
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+const identityMatrix *alignment::getSeqIdentities(void) {
+  if((identities == NULL) && (isAligned))
+    calculateSeqIdentity();
+  return identities;
+}
+
 /* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
 /* Returns the correspondence between the columns in the original and in the
  * trimmed alignment */
@@ -2968,24 +3364,28 @@ void alignment::removeSmallerBlocks(int blockSize) {
  * Once these columns/sequences have been identified, they are removed from
  * final alignment. */
 newValues alignment::removeCols_SeqsAllGaps(void) {
-  int i, j, valid, gaps;
+  int i, valid;
   bool warnings = false;
+  const uint64_t *gaps;
+  uint64_t *selected;
   newValues counter;
 
-  /* Check all valid columns looking for those composed by only gaps */
-  for(i = 0, counter.residues = 0; i < residNumber; i++) {
+  /* Check all valid columns looking for those composed by only gaps. Gaps
+   * from selected sequences are counted using the columns bit masks */
+  gaps = getColumnMasks(true);
+  selected = new uint64_t[columnWords];
+  memset(selected, 0, sizeof(uint64_t) * columnWords);
+  for(i = 0; i < sequenNumber; i++)
+    if(saveSequences[i] != -1)
+      selected[i >> 6] |= (uint64_t) 1 << (i & 63);
+  valid = utils::countBits(selected, columnWords);
+
+  for(i = 0, counter.residues = 0; i < residNumber; i++, gaps += columnWords) {
     if(saveResidues[i] == -1)
       continue;
 
-    for(j = 0, valid = 0, gaps = 0; j < sequenNumber; j++) {
-      if (saveSequences[j] == -1)
-        continue;
-      if (sequences[j][i] == '-')
-        gaps ++;
-      valid ++;
-    }
     /* Once a column has been identified, warm about it and remove it */
-    if(gaps == valid) {
+    if(utils::countCommonBits(gaps, selected, columnWords) == valid) {
       if(!warnings)
         cerr << endl;
       warnings = true;
@@ -2997,21 +3397,25 @@ newValues alignment::removeCols_SeqsAllGaps(void) {
     }
   }
 
+  delete [] selected;
+
   /* Check for those selected sequences to see whether there is anyone with
-   * only gaps */
-  for(i = 0, counter.sequences = 0; i < sequenNumber; i++) {
+   * only gaps. Gaps at selected columns are counted using the sequences bit
+   * masks */
+  gaps = getSequenceMasks(true);
+  selected = new uint64_t[sequenceWords];
+  memset(selected, 0, sizeof(uint64_t) * sequenceWords);
+  for(i = 0; i < residNumber; i++)
+    if(saveResidues[i] != -1)
+      selected[i >> 6] |= (uint64_t) 1 << (i & 63);
+  valid = utils::countBits(selected, sequenceWords);
+
+  for(i = 0, counter.sequences = 0; i < sequenNumber; i++, gaps += sequenceWords) {
     if(saveSequences[i] == -1)
       continue;
 
-    for(j = 0, valid = 0, gaps = 0; j < residNumber; j++) {
-      if(saveResidues[j] == -1)
-        continue;
-      if (sequences[i][j] == '-')
-        gaps ++;
-      valid ++;
-    }
     /* Warm about it and remove each sequence composed only by gaps */
-    if(gaps == valid) {
+    if(utils::countCommonBits(gaps, selected, sequenceWords) == valid) {
       if(!warnings)
         cerr << endl;
       warnings = true;
@@ -3032,6 +3436,8 @@ newValues alignment::removeCols_SeqsAllGaps(void) {
   if(warnings)
     cerr << endl;
 
+  delete [] selected;
+
   counter.matrix = new string[counter.sequences];
   counter.seqsName = new string[counter.sequences];
 
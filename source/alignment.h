@@ -43,6 +43,10 @@
 #include "sequencesMatrix.h"
 #include "statisticsConservation.h"
 #include "similarityMatrix.h"
+#include "identityMatrix.h"
+#include "mappedFile.h"
+#include "lineReader.h"
+#include "outputFile.h"
 #include "defines.h"
 #include "utils.h"
 
@@ -106,16 +110,54 @@ class alignment {
   /* Sequences */
   sequencesMatrix *seqMatrix;
 
-  /* Statistics */
+  /* Statistics. They are computed only when a method asks for them */
   statisticsGaps *sgaps;
   statisticsConservation *scons;
 
+  /* Similarity matrix for the conservation statistics */
+  similarityMatrix *simMatrix;
+
   /* Sequences Identities */
-  float **identities;
+  identityMatrix *identities;
 
   /* Sequences Overlaps */
   float **overlaps;
 
+  /* Gaps and indeterminations per column loaded from a binary alignment */
+  int *storedGaps;
+  int *storedIndets;
+
+  /* Residues encoded as small integer codes, stored in single blocks both
+   * sequence by sequence and column by column. They are built on demand */
+  unsigned char *residueCodes;
+  unsigned char *columnCodes;
+
+  /* Residue corresponding to each code */
+  char alphabet[256];
+  int alphabetSize;
+
+  /* Bit masks of valid residues, neither gaps nor indeterminations, and of
+   * gaps. They are stored sequence by sequence, using sequenceWords words
+   * each, and column by column, using columnWords words each */
+  uint64_t *sequenceMasks;
+  uint64_t *columnMasks;
+  int sequenceWords;
+  int columnWords;
+
+  /* Unique sequence of each sequence and positions of the first and second
+   * copies of every unique sequence, so pairwise scores are computed once
+   * for identical sequences. They are built on demand and they are not kept
+   * when every sequence is unique */
+  int *uniqueSeqs;
+  int *uniqueRows;
+  int uniqueNumber;
+
+  /* The same for identical columns, so per column statistics are computed
+   * once for each unique column */
+  int *uniqueCols;
+  int *uniqueColRows;
+  int uniqueColNumber;
+
   /* New Info */
   bool oldAlignment;
   int *residuesNumber;
@@ -139,6 +181,8 @@ class alignment {
   alignment *cleanStrict(int, const int *, float, const float *, bool, bool);
 
   alignment *cleanOverlapSeq(float, float *, bool);
+
+  char *getColumnColors(int &);
   /* ***** ***** ***** ***** ***** ***** ***** ***** ***** */
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** ***** */
@@ -151,7 +195,7 @@ class alignment {
   alignment(string, string, string *, string *, string *, int, int, int, int,
     bool, int, int, bool, bool, int, int,
     bool, bool, int, int, int *, int *, int *, int,
-     int, int, float **, float **);
+     int, int, identityMatrix *, float **);
 
   /* Overlap the operator = to use it as a constructor */
   alignment &operator=(const alignment &);
@@ -408,25 +452,31 @@ class alignment {
 
   /* ********** NEW CODE ********** */
   /* ********** ******** ********** */
-  int formatInputAlignment(char *);
+  int formatInputAlignment(lineReader &);
 
   int typeInputFile(void);
 
-  bool loadPhylipAlignment(char *);
+  bool loadPhylipAlignment(char *, lineReader &);
+
+  bool loadPhylipAlignment(char *, mappedFile &);
 
-  bool loadFastaAlignment(char *);
+  bool loadFastaAlignment(char *, lineReader &);
 
-  bool loadClustalAlignment(char *);
+  bool loadFastaAlignment(char *, mappedFile &);
 
-  bool loadNexusAlignment(char *);
+  bool loadClustalAlignment(char *, lineReader &);
 
-  bool loadMegaInterleavedAlignment(char *);
+  bool loadNexusAlignment(char *, lineReader &);
 
-  bool loadMegaNonInterleavedAlignment(char *);
+  bool loadMegaInterleavedAlignment(char *, lineReader &);
 
-  bool loadNBRF_PirAlignment(char *);
+  bool loadMegaNonInterleavedAlignment(char *, lineReader &);
 
-  bool loadPhylip3_2Alignment(char *);
+  bool loadNBRF_PirAlignment(char *, lineReader &);
+
+  bool loadPhylip3_2Alignment(char *, lineReader &);
+
+  bool loadBinaryAlignment(char *, mappedFile &);
   /* ********** ******** ********** */
   /* ********** ******** ********** */
 
@@ -447,6 +497,8 @@ class alignment {
 
   void alignmentMegaToFile(ostream &);
 
+  void alignmentBinaryToFile(ostream &);
+
   bool alignmentSummaryHTML(char *, int, int, int *, int *, float *);
 
   bool alignmentColourHTML(ostream &);
@@ -468,6 +520,8 @@ class alignment {
 
   void setReverse(void);
 
+  void setCase(bool);
+
   int getInputFormat(void);
 
   int getOutputFormat(void);
@@ -498,6 +552,22 @@ class alignment {
 
   int getTypeAlignment(void);
 
+  const unsigned char *getResidueCodes(void);
+
+  const unsigned char *getColumnCodes(void);
+
+  const char *getAlphabet(int &);
+
+  const uint64_t *getSequenceMasks(bool);
+
+  const uint64_t *getColumnMasks(bool);
+
+  const int *getUniqueSequences(int &, const int *&);
+
+  const int *getUniqueColumns(int &, const int *&);
+
+  const identityMatrix *getSeqIdentities(void);
+
   int *getCorrespResidues(void);
 
   int *getCorrespSequences(void);
@@ -24,118 +24,240 @@
 ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
 ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
 #include "alignment.h"
+#include "identityKernel.h"
+#include "threadPool.h"
 #include "defines.h"
 
+/* Scores computation for every pair of sequences, shared by identities and
+ * overlaps. Sequences are split into blocks small enough for two of them to
+ * stay together in the L2 cache and each task computes the pairs between two
+ * blocks. Tasks only cover the upper triangle and the threads of the shared
+ * pool take them one by one, so the triangular workload is balanced as the
+ * diagonal tasks, which are half-sized, finish earlier. When there are
+ * identical sequences, pairs are only computed between unique sequences,
+ * given by the position of their first copies, and between the first two
+ * copies of each one. Scores of other pairs are copied from those */
+struct pairsJob {
+  const unsigned char *codes;
+  const uint64_t *masks;
+  int length;
+  int sequences;
+  bool diagonal;
+
+  /* Unique sequence of each sequence and positions of the first and second
+   * copies of each unique sequence. Without them, every sequence is unique */
+  const int *unique;
+  const int *rows;
+  int alignSequences;
+
+  /* Blocks pair for each task */
+  int block;
+  int *tiles;
+
+  /* Output matrices and valid residues per sequence for overlaps */
+  identityMatrix *identities;
+  float **scores;
+  int *lengths;
+
+  /* Score for a pair of sequences */
+  void (*pair)(pairsJob *, int, int);
+};
+
+static void pairsTask(int task, void *data) {
+  pairsJob *job = (pairsJob *) data;
+  int i, j, firstEnd, secondStart, secondEnd;
+
+  firstEnd = utils::min((job -> tiles[2 * task] + 1) * job -> block,
+    job -> sequences);
+  secondStart = job -> tiles[2 * task + 1] * job -> block;
+  secondEnd = utils::min(secondStart + job -> block, job -> sequences);
+
+  for(i = job -> tiles[2 * task] * job -> block; i < firstEnd; i++)
+    for(j = utils::max(secondStart, job -> diagonal ? i : i + 1); j < secondEnd; j++)
+      if(job -> rows == NULL)
+        job -> pair(job, i, j);
+      else
+        job -> pair(job, job -> rows[2 * i], job -> rows[2 * j]);
+}
+
+/* Scores of the pairs of sequences starting at a block of rows are copied
+ * from the pairs computed for their unique sequences */
+static void copiesTask(int task, void *data) {
+  pairsJob *job = (pairsJob *) data;
+  int i, j, k, l, last;
+
+  last = utils::min((task + 1) * COPIESBLOCK, job -> alignSequences);
+
+  for(i = task * COPIESBLOCK; i < last; i++)
+    for(j = job -> diagonal ? i : i + 1; j < job -> alignSequences; j++) {
+      k = job -> rows[2 * job -> unique[i]];
+      if(i == j)
+        l = k;
+      else if(job -> unique[i] == job -> unique[j])
+        l = job -> rows[2 * job -> unique[j] + 1];
+      else
+        l = job -> rows[2 * job -> unique[j]];
+
+      if((i == k) && (j == l))
+        continue;
+
+      if(job -> identities != NULL)
+        job -> identities -> copy(i, j, k, l);
+      else {
+        job -> scores[i][j] = job -> scores[k][l];
+        job -> scores[j][i] = job -> scores[l][k];
+      }
+    }
+}
+
+static void computePairs(pairsJob &job, int rowBytes) {
+  int i, j, blocks, tasks;
+
+  /* Two blocks of sequences should fit into PAIRSCACHE bytes */
+  job.block = utils::max(PAIRSCACHE / utils::max(2 * rowBytes, 1), 8);
+  blocks = (job.sequences + job.block - 1) / job.block;
+  tasks = blocks * (blocks + 1) / 2;
+
+  job.tiles = new int[2 * tasks];
+  for(i = 0, tasks = 0; i < blocks; i++)
+    for(j = i; j < blocks; j++, tasks++) {
+      job.tiles[2 * tasks] = i;
+      job.tiles[2 * tasks + 1] = j;
+    }
+
+  threadPool::runShared(tasks, pairsTask, &job);
+  delete [] job.tiles;
+
+  /* Compute the pairs between the first two copies of each unique sequence
+   * and copy their scores to every other pair */
+  if(job.unique != NULL) {
+    for(i = 0; i < job.sequences; i++)
+      if(job.rows[2 * i + 1] != -1)
+        job.pair(&job, job.rows[2 * i], job.rows[2 * i + 1]);
+    threadPool::runShared((job.alignSequences + COPIESBLOCK - 1) / COPIESBLOCK, copiesTask, &job);
+  }
+}
+
+static void identityPair(pairsJob *job, int i, int j) {
+  int hit, dst;
+
+  /* Positions where any of both sequences has a valid residue count for the
+   * common length, and those with the same valid residue count as a hit */
+  identityKernel::compare(job -> codes + (size_t) i * job -> length,
+    job -> codes + (size_t) j * job -> length, job -> length, hit, dst);
+
+  /* Identity score between two sequences is the ratio of identical residues
+   * by the total length (common and no-common residues) among them */
+  job -> identities -> set(i, j, (float) hit/dst);
+}
+
+static void relaxedIdentityPair(pairsJob *job, int i, int j) {
+  const unsigned char *first, *second;
+  int k, hit;
+
+  first = job -> codes + (size_t) i * job -> length;
+  second = job -> codes + (size_t) j * job -> length;
+
+  /* If both positions are the same, count a hit */
+  for(k = 0, hit = 0; k < job -> length; k++)
+    hit += (first[k] == second[k]);
+
+  /* Raw identity score is computed as the ratio of identical residues between
+   * alignment length */
+  job -> identities -> set(i, j, (float) hit/job -> length);
+}
+
+static void overlapPair(pairsJob *job, int i, int j) {
+  int shared;
+
+  /* Valid residues shared by both sequences */
+  shared = utils::countCommonBits(job -> masks + (size_t) i * job -> length,
+    job -> masks + (size_t) j * job -> length, job -> length);
+
+  /* Overlap score between two sequences is the ratio of shared valid
+   * residues divided by the sequence length taken as reference. The
+   * overlaps matrix, therefore, will be not symmetric. */
+  job -> scores[i][j] = (float) shared/job -> lengths[i];
+  job -> scores[j][i] = (float) shared/job -> lengths[j];
+}
+
 /* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
 /* This function computes the identities values between the sequences from
  * the alignment */
 /* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
 void alignment::calculateSeqIdentity(void) {
 
-  int i, j, k, hit, dst;
-  char indet;
+  pairsJob job;
 
-  /* Depending on alignment type, indetermination symbol will be one or other */
-  indet = getTypeAlignment() == AAType ? 'X' : 'N';
+  /* Identities may have been already computed or loaded from a binary file */
+  if(identities != NULL)
+    return;
 
   /* Create identities matrix to store identities scores */
-  identities = new float*[sequenNumber];
+  identities = new identityMatrix(sequenNumber, 1);
 
   /* For each seq, compute its identity score against the others in the MSA */
-  for(i = 0; i < sequenNumber; i++) {
-    identities[i] = new float[sequenNumber];
-
-    /* It's a symmetric matrix, copy values that have been already computed */
-    for(j = 0; j < i; j++)
-      identities[i][j] = identities[j][i];
-    identities[i][i] = 0;
-
-    /* Compute identity scores for the current sequence against the rest */
-    for(j = i + 1; j < sequenNumber; j++) {
-      for(k = 0, hit = 0, dst = 0; k < residNumber; k++) {
-      /* If one of the two positions is a valid residue,
-       * count it for the common length */
-        if(((sequences[i][k] != indet) && (sequences[i][k] != '-')) ||
-           ((sequences[j][k] != indet) && (sequences[j][k] != '-'))) {
-          dst++;
-          /* If both positions are the same, count a hit */
-          if(sequences[i][k] == sequences[j][k])
-            hit++;
-        }
-      }
-
-      /* Identity score between two sequences is the ratio of identical residues
-       * by the total length (common and no-common residues) among them */
-      identities[i][j] = (float) hit/dst;
-    }
-  }
+  job.codes = getResidueCodes();
+  job.length = residNumber;
+  job.unique = getUniqueSequences(job.sequences, job.rows);
+  job.alignSequences = sequenNumber;
+  job.diagonal = false;
+  job.identities = identities;
+  job.pair = identityPair;
+  computePairs(job, residNumber);
 }
 
 void alignment::calculateSeqOverlap(void) {
   /* Compute the overlap between sequences taken each of them as the reference
    * to compute such scores. It will lead to a non-symmetric matrix. */
 
-  int i, j, k, shared, referenceLength;
-  char indet;
+  pairsJob job;
+  int i;
 
-  /* Depending on alignment type, indetermination symbol will be one or other */
-  indet = getTypeAlignment() == AAType ? 'X' : 'N';
+  /* Bit masks of valid residues for each sequence */
+  job.masks = getSequenceMasks(false);
+  job.length = sequenceWords;
+  job.unique = getUniqueSequences(job.sequences, job.rows);
+  job.alignSequences = sequenNumber;
+  job.diagonal = true;
+  job.identities = NULL;
 
   /* Create overlap matrix to store overlap scores */
   overlaps = new float*[sequenNumber];
-
-  /* For each seq, compute its overlap score against the others in the MSA */
+  job.lengths = new int[sequenNumber];
   for(i = 0; i < sequenNumber; i++) {
     overlaps[i] = new float[sequenNumber];
-
-    for(j = 0; j < sequenNumber; j++) {
-      for(k = 0, shared = 0, referenceLength = 0; k < residNumber; k++) {
-        /* If there a valid residue for the reference sequence, then see if
-         * there is a valid residue for the other sequence. */
-        if((sequences[i][k] != indet) && (sequences[i][k] != '-')) {
-          referenceLength++;
-          if ((sequences[j][k] != indet) && (sequences[j][k] != '-'))
-            shared++;
-        }
-      }
-      /* Overlap score between two sequences is the ratio of shared valid
-       * residues divided by the sequence length taken as reference. The
-       * overlaps matrix, therefore, will be not symmetric. */
-      overlaps[i][j] = (float) shared/referenceLength;
-    }
+    job.lengths[i] = utils::countBits(job.masks + (size_t) i * sequenceWords,
+      sequenceWords);
   }
+
+  /* For each pair of sequences, compute both overlap scores taking each one
+   * of them as the reference */
+  job.scores = overlaps;
+  job.pair = overlapPair;
+  computePairs(job, sizeof(uint64_t) * sequenceWords);
+
+  delete [] job.lengths;
 }
 
 void alignment::calculateRelaxedSeqIdentity(void) {
   /* Raw approximation of sequence identity computation designed for reducing
    * comparisons for huge alignemnts */
 
-  int i, j, k, hit;
+  pairsJob job;
 
   /* Create identities matrix to store identities scores */
-  identities = new float*[sequenNumber];
-
-  /* For each seq, compute its identity score against the others in the MSA */
-  for(i = 0; i < sequenNumber; i++) {
-    identities[i] = new float[sequenNumber];
-
-    /* It's a symmetric matrix, copy values that have been already computed */
-    for(j = 0; j < i; j++)
-      identities[i][j] = identities[j][i];
-    identities[i][i] = 0;
-
-    /* Compute identity score between the selected sequence and the others */
-    for(j = i + 1; j < sequenNumber; j++) {
-      for(k = 0, hit = 0; k < residNumber; k++) {
-        /* If both positions are the same, count a hit */
-        if(sequences[i][k] == sequences[j][k])
-          hit++;
-      }
-    /* Raw identity score is computed as the ratio of identical residues between
-     * alignment length */
-      identities[i][j] = (float) hit/residNumber;
-    }
-  }
+  identities = new identityMatrix(sequenNumber, 1);
+
+  /* Compute identity score between each sequence and the others */
+  job.codes = getResidueCodes();
+  job.length = residNumber;
+  job.unique = getUniqueSequences(job.sequences, job.rows);
+  job.alignSequences = sequenNumber;
+  job.diagonal = false;
+  job.identities = identities;
+  job.pair = relaxedIdentityPair;
+  computePairs(job, residNumber);
 }
 
 
@@ -165,8 +287,8 @@ int alignment::selectMethod(void) {
   for(i = 0; i < sequenNumber; i++) {
     for(j = 0, mx = 0, avg = 0; j < sequenNumber; j++) {
       if(i != j) {
-        mx  = mx < identities[i][j] ? identities[i][j] : mx;
-        avg += identities[i][j];
+        mx  = mx < identities -> get(i, j) ? identities -> get(i, j) : mx;
+        avg += identities -> get(i, j);
       }
     }
     avgSeq += avg/(sequenNumber - 1);
@@ -225,9 +347,9 @@ void alignment::printSeqIdentity(void) {
     /* Get the most similar sequence to the current one in term of identity */
     for(k = 0, mx = 0, avg = 0, pos = i; k < sequenNumber; k++) {
       if(i != k) {
-        avg += identities[i][k];
-        if(mx < identities[i][k]) {
-          mx = identities[i][k];
+        avg += identities -> get(i, k);
+        if(mx < identities -> get(i, k)) {
+          mx = identities -> get(i, k);
           pos = k;
         }
       }
@@ -268,10 +390,10 @@ void alignment::printSeqIdentity(void) {
   for(i = 0; i < sequenNumber; i++) {
     cout << endl << setw(maxLongName + 2) << left << seqsName[i] << "\t";
     for(j = 0; j < i; j++)
-      cout << setiosflags(ios::left) << setw(10) << identities[i][j] << "\t";
+      cout << setiosflags(ios::left) << setw(10) << identities -> get(i, j) << "\t";
     cout << setiosflags(ios::left) << setw(10) << 1.00 << "\t";
     for(j = i + 1; j < sequenNumber; j++)
-      cout << setiosflags(ios::left) << setw(10) << identities[i][j] << "\t";
+      cout << setiosflags(ios::left) << setw(10) << identities -> get(i, j) << "\t";
   }
   cout << endl;
 
@@ -360,44 +482,47 @@ void alignment::printSeqOverlap(void) {
 /* *** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *** */
 void alignment::calculateColIdentity(float *ColumnIdentities) {
 
-  int i, j, counter, pos, max, columnLen;
-  char letter, indet, gapSymbol;
-  string column;
+  int i, j, max, columnLen, size, uniques, letters[256], counter[256];
+  const int *unique, *rows;
+  const unsigned char *column;
+  const char *residues;
+  char indet;
 
   /* Initialize some data for make computation more precise */
   indet = getTypeAlignment() == AAType ? 'X' : 'N';
-  gapSymbol = '-';
+
+  /* Map each residue code to its capital letter. Gaps and indeterminations,
+   * in any case, are discarded from calculations */
+  column = getColumnCodes();
+  residues = getAlphabet(size);
+  for(i = 0; i < size; i++)
+    letters[i] = (unsigned char) toupper(residues[i]);
+  letters[GAPCODE] = -1;
+  for(i = 0; i < size; i++)
+    if(letters[i] == indet)
+      letters[i] = -1;
 
   /* Compute identity score for the most frequent residue, it can be as well
-   * gaps and indeterminations, for each column */
-  for(i = 0, max = 0; i < residNumber; i++, max = 0, column.clear()) {
+   * gaps and indeterminations, for each column. Columns are read from the
+   * column-major copy of the alignment. Identical columns get the score of
+   * their first copy */
+  unique = getUniqueColumns(uniques, rows);
+  for(i = 0; i < residNumber; i++, column += sequenNumber) {
+
+    if((unique != NULL) && (rows[2 * unique[i]] != i)) {
+      ColumnIdentities[i] = ColumnIdentities[rows[2 * unique[i]]];
+      continue;
+    }
 
-    /* Get residues from each column in capital letters */
-    for(j = 0; j < sequenNumber; j++)
-      /* Discard gaps and indeterminations from calculations */
-      if((toupper(sequences[j][i]) != indet) && (sequences[j][i] != gapSymbol))
-        column += toupper(sequences[j][i]);
-    columnLen = column.size();
-
-    /* Count letter frequency. It only matter the frequency. Use some shorcuts
-     * to speed-up the process */
-    while (!column.empty()) {
-      letter = column[0];
-      counter = 0;
-      pos = 0;
-
-      do {
-        counter += 1;
-        column.erase(pos, 1);
-        pos = column.find(letter, pos);
-      } while(pos != (int) string::npos);
-
-      /* Keep only the most frequent residue */
-      if(counter > max)
-        max = counter;
-      /* If column size is smaller than the current max, stop the count */
-      if((int) column.size() < max)
-        break;
+    /* Count letters frequency in capital letters while keeping the most
+     * frequent one */
+    utils::initlVect(counter, 256, 0);
+    for(j = 0, max = 0, columnLen = 0; j < sequenNumber; j++) {
+      if(letters[column[j]] == -1)
+        continue;
+      columnLen++;
+      if(++counter[letters[column[j]]] > max)
+        max = counter[letters[column[j]]];
     }
 
     /* Store column identity values */
@@ -52,3 +52,24 @@
 
 #define HTMLBLOCKS 120
 #define PHYLIPDISTANCE 10
+
+#define READBLOCK  4194304
+#define WRITEBLOCK 1048576
+#define PARALLELBLOCK 1048576
+#define TRANSPOSEBLOCK 64
+#define PAIRSCACHE 262144
+#define COPIESBLOCK 64
+#define DISTANCETABLE 32
+#define CONSERVATIONBLOCK 16
+#define CONFIDENCEZ 2.576
+
+#define GAPCODE   0
+#define INDETCODE 1
+
+#define BINARYGAPS     1
+#define BINARYIDENTITY 2
+#define BINARYINFO     4
+
+#define PLAINFILE 0
+#define GZIPFILE  1
+#define ZSTDFILE  2
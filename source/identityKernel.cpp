@@ -0,0 +1,163 @@
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+   ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+
+    trimAl v1.4: a tool for automated alignment trimming in large-scale
+                 phylogenetics analyses.
+
+    2009-2015 Capella-Gutierrez S. and Gabaldon, T.
+              [scapella, tgabaldon]@crg.es
+
+    This file is part of trimAl
+
+    trimAl is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, the last available version.
+
+    trimAl is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with trimAl. If not, see <http://www.gnu.org/licenses/>.
+
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+
+#include "identityKernel.h"
+#include "defines.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define IDENTITY_X86
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define IDENTITY_NEON
+#include <arm_neon.h>
+#endif
+
+typedef void (*compareFunction)(const unsigned char *, const unsigned char *, int, int &, int &);
+
+/* Scalar version. It is used as well for the last positions of vectorized
+ * versions */
+static void compareScalar(const unsigned char *first, const unsigned char *second, int length,
+  int &hits, int &valid) {
+
+  int i;
+
+  for(i = 0, hits = 0, valid = 0; i < length; i++) {
+    hits += (first[i] == second[i]) & (first[i] > INDETCODE);
+    valid += (first[i] > INDETCODE) | (second[i] > INDETCODE);
+  }
+}
+
+#ifdef IDENTITY_X86
+/* A position is not valid when its code is not greater than INDETCODE, i.e.
+ * when its minimum with INDETCODE is the code itself. Comparisons give one
+ * byte per position which are turned into bits and counted */
+__attribute__((target("avx2,popcnt")))
+static void compareAVX2(const unsigned char *first, const unsigned char *second, int length,
+  int &hits, int &valid) {
+
+  __m256i a, b, indet, same, invalidA, invalidAny;
+  int i, tailHits, tailValid;
+
+  indet = _mm256_set1_epi8(INDETCODE);
+
+  for(i = 0, hits = 0, valid = 0; i + 32 <= length; i += 32) {
+    a = _mm256_loadu_si256((const __m256i *) (first + i));
+    b = _mm256_loadu_si256((const __m256i *) (second + i));
+
+    same = _mm256_cmpeq_epi8(a, b);
+    invalidA = _mm256_cmpeq_epi8(_mm256_min_epu8(a, indet), a);
+    b = _mm256_max_epu8(a, b);
+    invalidAny = _mm256_cmpeq_epi8(_mm256_min_epu8(b, indet), b);
+
+    hits += __builtin_popcount((unsigned) _mm256_movemask_epi8(_mm256_andnot_si256(invalidA, same)));
+    valid += 32 - __builtin_popcount((unsigned) _mm256_movemask_epi8(invalidAny));
+  }
+
+  compareScalar(first + i, second + i, length - i, tailHits, tailValid);
+  hits += tailHits;
+  valid += tailValid;
+}
+
+__attribute__((target("sse4.2,popcnt")))
+static void compareSSE(const unsigned char *first, const unsigned char *second, int length,
+  int &hits, int &valid) {
+
+  __m128i a, b, indet, same, invalidA, invalidAny;
+  int i, tailHits, tailValid;
+
+  indet = _mm_set1_epi8(INDETCODE);
+
+  for(i = 0, hits = 0, valid = 0; i + 16 <= length; i += 16) {
+    a = _mm_loadu_si128((const __m128i *) (first + i));
+    b = _mm_loadu_si128((const __m128i *) (second + i));
+
+    same = _mm_cmpeq_epi8(a, b);
+    invalidA = _mm_cmpeq_epi8(_mm_min_epu8(a, indet), a);
+    b = _mm_max_epu8(a, b);
+    invalidAny = _mm_cmpeq_epi8(_mm_min_epu8(b, indet), b);
+
+    hits += __builtin_popcount((unsigned) _mm_movemask_epi8(_mm_andnot_si128(invalidA, same)));
+    valid += 16 - __builtin_popcount((unsigned) _mm_movemask_epi8(invalidAny));
+  }
+
+  compareScalar(first + i, second + i, length - i, tailHits, tailValid);
+  hits += tailHits;
+  valid += tailValid;
+}
+#endif
+
+#ifdef IDENTITY_NEON
+/* Comparisons give one byte per position set to all ones, shifting them
+ * leaves a one per matching position which are added across the vector */
+static void compareNEON(const unsigned char *first, const unsigned char *second, int length,
+  int &hits, int &valid) {
+
+  uint8x16_t a, b, indet, same, any;
+  int i, tailHits, tailValid;
+
+  indet = vdupq_n_u8(INDETCODE);
+
+  for(i = 0, hits = 0, valid = 0; i + 16 <= length; i += 16) {
+    a = vld1q_u8(first + i);
+    b = vld1q_u8(second + i);
+
+    same = vandq_u8(vceqq_u8(a, b), vcgtq_u8(a, indet));
+    any = vcgtq_u8(vmaxq_u8(a, b), indet);
+
+    hits += vaddvq_u8(vshrq_n_u8(same, 7));
+    valid += vaddvq_u8(vshrq_n_u8(any, 7));
+  }
+
+  compareScalar(first + i, second + i, length - i, tailHits, tailValid);
+  hits += tailHits;
+  valid += tailValid;
+}
+#endif
+
+/* Select the widest version supported by the running processor */
+static compareFunction selectFunction(void) {
+
+  #ifdef IDENTITY_X86
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+    return compareAVX2;
+  if(__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt"))
+    return compareSSE;
+  #endif
+
+  #ifdef IDENTITY_NEON
+  return compareNEON;
+  #else
+  return compareScalar;
+  #endif
+}
+
+static const compareFunction function = selectFunction();
+
+void identityKernel::compare(const unsigned char *first, const unsigned char *second, int length,
+  int &hits, int &valid) {
+  function(first, second, length, hits, valid);
+}
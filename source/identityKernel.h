@@ -0,0 +1,48 @@
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+   ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+
+    trimAl v1.4: a tool for automated alignment trimming in large-scale
+                 phylogenetics analyses.
+
+    2009-2015 Capella-Gutierrez S. and Gabaldon, T.
+              [scapella, tgabaldon]@crg.es
+
+    This file is part of trimAl
+
+    trimAl is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, the last available version.
+
+    trimAl is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with trimAl. If not, see <http://www.gnu.org/licenses/>.
+
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+
+#ifndef IDENTITYKERNEL_H
+#define IDENTITYKERNEL_H
+
+/* ***************************************************************************************************************** */
+/*                                         Header Class File: identityKernel.                                        */
+/* ***************************************************************************************************************** */
+
+/* Pairwise comparison of two sequences stored as residues codes, where gaps
+ * and indeterminations have the lowest codes. It is the inner loop of every
+ * identity computation, so it is vectorized using the widest instruction set
+ * available in the running processor, which is detected when the program
+ * starts. All versions give the same results than the scalar one */
+
+class identityKernel {
+
+ public:
+
+  /* Count the positions where both sequences have the same valid residue,
+   * and the positions where any of them has a valid residue */
+  static void compare(const unsigned char *, const unsigned char *, int, int &, int &);
+};
+#endif
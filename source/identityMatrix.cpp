@@ -0,0 +1,78 @@
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+   ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+
+    trimAl v1.4: a tool for automated alignment trimming in large-scale
+                 phylogenetics analyses.
+
+    2009-2015 Capella-Gutierrez S. and Gabaldon, T.
+              [scapella, tgabaldon]@crg.es
+
+    This file is part of trimAl
+
+    trimAl is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, the last available version.
+
+    trimAl is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with trimAl. If not, see <http://www.gnu.org/licenses/>.
+
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+
+#include <string.h>
+
+#include "identityMatrix.h"
+
+bool identityMatrix::compactDefault = false;
+
+identityMatrix::identityMatrix(int numSequences, float maximumScore) {
+  size_t pairs;
+
+  sequences = numSequences;
+  maximum = maximumScore;
+  pairs = (size_t) sequences * (sequences - 1) / 2;
+
+  values = NULL;
+  compactValues = NULL;
+
+  if(compactDefault) {
+    compactValues = new unsigned short[pairs];
+    memset(compactValues, 0, pairs * sizeof(unsigned short));
+  } else {
+    values = new float[pairs];
+    memset(values, 0, pairs * sizeof(float));
+  }
+}
+
+identityMatrix::identityMatrix(const identityMatrix &old) {
+  size_t pairs;
+
+  sequences = old.sequences;
+  maximum = old.maximum;
+  pairs = (size_t) sequences * (sequences - 1) / 2;
+
+  values = NULL;
+  compactValues = NULL;
+
+  if(old.values != NULL) {
+    values = new float[pairs];
+    memcpy(values, old.values, pairs * sizeof(float));
+  } else {
+    compactValues = new unsigned short[pairs];
+    memcpy(compactValues, old.compactValues, pairs * sizeof(unsigned short));
+  }
+}
+
+identityMatrix::~identityMatrix(void) {
+  delete [] values;
+  delete [] compactValues;
+}
+
+void identityMatrix::setCompact(bool compact) {
+  compactDefault = compact;
+}
@@ -0,0 +1,118 @@
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+   ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+
+    trimAl v1.4: a tool for automated alignment trimming in large-scale
+                 phylogenetics analyses.
+
+    2009-2015 Capella-Gutierrez S. and Gabaldon, T.
+              [scapella, tgabaldon]@crg.es
+
+    This file is part of trimAl
+
+    trimAl is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, the last available version.
+
+    trimAl is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with trimAl. If not, see <http://www.gnu.org/licenses/>.
+
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+
+#ifndef IDENTITYMATRIX_H
+#define IDENTITYMATRIX_H
+
+#include <stddef.h>
+
+/* ***************************************************************************************************************** */
+/*                                         Header Class File: identityMatrix.                                        */
+/* ***************************************************************************************************************** */
+
+/* Symmetric matrix of scores between every pair of sequences with a zero
+ * diagonal, such as identities. Only the upper triangle is stored, row after
+ * row, either as floats or, in compact mode, as 16 bits fixed point values
+ * between 0 and the maximum score. Accessors are defined here since they are
+ * called for every pair of sequences */
+
+class identityMatrix {
+
+  int sequences;
+  float maximum;
+
+  float *values;
+  unsigned short *compactValues;
+
+  /* Default storage for new matrices */
+  static bool compactDefault;
+
+  /* Position of the pair (i, j), being i < j, in the upper triangle */
+  size_t position(int i, int j) const {
+    return (size_t) i * (2 * sequences - i - 3) / 2 + j - 1;
+  }
+
+ public:
+
+  /* Class constructor. Scores are between 0 and the given maximum and all
+   * of them are set to 0 */
+  identityMatrix(int, float);
+
+  /* Copy constructor */
+  identityMatrix(const identityMatrix &);
+
+  /* Class destroyer */
+  ~identityMatrix(void);
+
+  /* Number of sequences */
+  int getSequences(void) const { return sequences; }
+
+  /* Check whether scores are stored as fixed point values */
+  bool isCompact(void) const { return compactValues != NULL; }
+
+  /* Score for a pair of sequences */
+  float get(int i, int j) const {
+    size_t k;
+
+    if(i == j)
+      return 0;
+    k = (i < j) ? position(i, j) : position(j, i);
+    return (values != NULL) ? values[k] : compactValues[k] * (maximum / 65535);
+  }
+
+  /* Set score for a pair of sequences. Diagonal is always 0 */
+  void set(int i, int j, float value) {
+    size_t k;
+
+    if(i == j)
+      return;
+    k = (i < j) ? position(i, j) : position(j, i);
+    if(values != NULL)
+      values[k] = value;
+    else {
+      value = (value < 0) ? 0 : ((value > maximum) ? maximum : value);
+      compactValues[k] = (unsigned short) (value / maximum * 65535 + 0.5);
+    }
+  }
+
+  /* Copy the score of the pair (k, l) to the pair (i, j), being both pairs
+   * out of the diagonal. It keeps the stored value as it is */
+  void copy(int i, int j, int k, int l) {
+    size_t to, from;
+
+    to = (i < j) ? position(i, j) : position(j, i);
+    from = (k < l) ? position(k, l) : position(l, k);
+    if(values != NULL)
+      values[to] = values[from];
+    else
+      compactValues[to] = compactValues[from];
+  }
+
+  /* Store new matrices as 16 bits fixed point values, halving their memory
+   * at the cost of a precision about 1e-5 times the maximum score */
+  static void setCompact(bool);
+};
+#endif
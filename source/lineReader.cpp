@@ -0,0 +1,562 @@
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+   ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+
+    trimAl v1.4: a tool for automated alignment trimming in large-scale
+                 phylogenetics analyses.
+
+    2009-2015 Capella-Gutierrez S. and Gabaldon, T.
+              [scapella, tgabaldon]@crg.es
+
+    This file is part of trimAl
+
+    trimAl is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, the last available version.
+
+    trimAl is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with trimAl. If not, see <http://www.gnu.org/licenses/>.
+
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#include <iostream>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "lineReader.h"
+
+lineReader::lineReader(void) {
+  /* Initialize a reader without any input file */
+  fd = -1;
+  compression = PLAINFILE;
+
+  buffer = NULL;
+  capacity = 0;
+  begin = 0;
+  end = 0;
+
+  exhausted = true;
+  endOfFile = true;
+  intact = false;
+  seekable = false;
+
+  copy = NULL;
+  copySize = 0;
+
+  decoder = NULL;
+  packed = NULL;
+  packedSize = 0;
+  packedBegin = 0;
+  packedEnd = 0;
+  unfinished = false;
+}
+
+lineReader::~lineReader(void) {
+  /* Close the input file and release the buffer */
+  close();
+}
+
+bool lineReader::open(const char *fileName) {
+  /* Open input file and check it is not empty. A "-" stands for the
+   * standard input. Pipes are accepted as well: they are read only once,
+   * so file beginning is kept in the buffer while the input format is
+   * detected */
+  struct stat info;
+  long bytes;
+
+  close();
+
+  if(!strcmp(fileName, "-"))
+    fd = dup(STDIN_FILENO);
+  else
+    fd = ::open(fileName, O_RDONLY);
+
+  if(fd == -1)
+    return false;
+
+  if((fstat(fd, &info) == -1) || (S_ISDIR(info.st_mode)) ||
+    ((S_ISREG(info.st_mode)) && (info.st_size == 0))) {
+    close();
+    return false;
+  }
+
+  /* Input files are always read from the beginning to the end. Some
+   * systems, e.g. MacOS, do not provide this hint */
+#ifdef POSIX_FADV_SEQUENTIAL
+  if(S_ISREG(info.st_mode))
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+  /* A extra byte is always kept at the buffer end to close the last line */
+  capacity = READBLOCK + 1;
+  buffer = (char *) malloc(capacity);
+
+  /* Get the first bytes to check whether input file is compressed */
+  for(end = 0; end < 4; end += bytes) {
+    do {
+      bytes = read(fd, buffer + end, 4 - end);
+    } while((bytes == -1) && (errno == EINTR));
+
+    if(bytes <= 0)
+      break;
+  }
+
+  if(end == 0) {
+    close();
+    return false;
+  }
+
+  /* Compressed data already read is given to its decoder */
+  compression = detectCompression(buffer, end);
+  if(compression != PLAINFILE) {
+    if(!openDecoder()) {
+      close();
+      return false;
+    }
+    memcpy(packed, buffer, end);
+    packedEnd = end;
+    end = 0;
+  }
+
+  /* Only plain regular files are read again from disk when going back */
+  seekable = (S_ISREG(info.st_mode)) && (compression == PLAINFILE);
+
+  begin = 0;
+  exhausted = false;
+  endOfFile = false;
+  intact = true;
+
+  return true;
+}
+
+void lineReader::close(void) {
+  /* Close input file and deallocate the buffer */
+#ifdef HAVE_ZLIB
+  if((compression == GZIPFILE) && (decoder != NULL)) {
+    inflateEnd((z_stream *) decoder);
+    delete (z_stream *) decoder;
+  }
+#endif
+#ifdef HAVE_ZSTD
+  if((compression == ZSTDFILE) && (decoder != NULL))
+    ZSTD_freeDStream((ZSTD_DStream *) decoder);
+#endif
+  decoder = NULL;
+  compression = PLAINFILE;
+
+  delete [] packed;
+  packed = NULL;
+  packedSize = 0;
+  packedBegin = 0;
+  packedEnd = 0;
+  unfinished = false;
+
+  if(fd != -1)
+    ::close(fd);
+  fd = -1;
+
+  free(buffer);
+  buffer = NULL;
+  capacity = 0;
+
+  delete [] copy;
+  copy = NULL;
+  copySize = 0;
+
+  begin = 0;
+  end = 0;
+  exhausted = true;
+  endOfFile = true;
+  intact = false;
+  seekable = false;
+}
+
+int lineReader::detectCompression(const char *data, long size) {
+  /* Look for gzip and zstd magic numbers */
+  if((size >= 2) && ((unsigned char) data[0] == 0x1F) &&
+    ((unsigned char) data[1] == 0x8B))
+    return GZIPFILE;
+
+  if((size >= 4) && ((unsigned char) data[0] == 0x28) &&
+    ((unsigned char) data[1] == 0xB5) && ((unsigned char) data[2] == 0x2F) &&
+    ((unsigned char) data[3] == 0xFD))
+    return ZSTDFILE;
+
+  return PLAINFILE;
+}
+
+int lineReader::getCompression(void) {
+  return compression;
+}
+
+bool lineReader::openDecoder(void) {
+  /* Prepare the decompression stream according to input file compression.
+   * Warn about it if support for that format is not available */
+  switch(compression) {
+
+    case GZIPFILE:
+#ifdef HAVE_ZLIB
+    {
+      /* Adding 32 to the window bits makes zlib to expect a gzip header */
+      z_stream *stream = new z_stream;
+      memset(stream, 0, sizeof(z_stream));
+      if(inflateInit2(stream, 15 + 32) != Z_OK) {
+        delete stream;
+        return false;
+      }
+      decoder = stream;
+
+      packedSize = READBLOCK / 4;
+      packed = new char[packedSize];
+      packedBegin = 0;
+      packedEnd = 0;
+      return true;
+    }
+#else
+      cerr << endl << "ERROR: Input file is compressed using gzip but "
+        << "this build does not support it. Rebuild it with zlib "
+        << "installed." << endl;
+      return false;
+#endif
+
+    case ZSTDFILE:
+#ifdef HAVE_ZSTD
+      if((decoder = ZSTD_createDStream()) == NULL)
+        return false;
+      ZSTD_initDStream((ZSTD_DStream *) decoder);
+
+      packedSize = ZSTD_DStreamInSize();
+      packed = new char[packedSize];
+      packedBegin = 0;
+      packedEnd = 0;
+      unfinished = false;
+      return true;
+#else
+      cerr << endl << "ERROR: Input file is compressed using zstd but "
+        << "this build does not support it. Rebuild it with libzstd "
+        << "installed." << endl;
+      return false;
+#endif
+  }
+  return true;
+}
+
+long lineReader::readSource(char *dest, long size) {
+  /* Fill the destination area with plain data from input file. Compressed
+   * files are decompressed incrementally */
+  long bytes;
+
+#ifdef HAVE_ZLIB
+  if(compression == GZIPFILE) {
+    z_stream *stream = (z_stream *) decoder;
+    int state;
+
+    stream -> next_out = (Bytef *) dest;
+    stream -> avail_out = (uInt) size;
+
+    /* Feed the decoder until it gives back some data. Files made of several
+     * gzip members, e.g. concatenated files, are decoded one after another */
+    while(stream -> avail_out == (uInt) size) {
+      if(packedBegin == packedEnd) {
+        do {
+          bytes = read(fd, packed, packedSize);
+        } while((bytes == -1) && (errno == EINTR));
+
+        if(bytes == -1)
+          return -1;
+        packedBegin = 0;
+        packedEnd = bytes;
+
+        /* Input file is over. It is an error in the middle of a member */
+        if(bytes == 0) {
+          if(stream -> total_in == 0)
+            break;
+          cerr << endl << "ERROR: Input file is not a valid gzip file." << endl;
+          return -1;
+        }
+      }
+
+      stream -> next_in = (Bytef *) packed + packedBegin;
+      stream -> avail_in = (uInt) (packedEnd - packedBegin);
+
+      state = inflate(stream, Z_NO_FLUSH);
+      packedBegin = packedEnd - stream -> avail_in;
+
+      if(state == Z_STREAM_END)
+        inflateReset(stream);
+      else if((state != Z_OK) && (state != Z_BUF_ERROR)) {
+        cerr << endl << "ERROR: Input file is not a valid gzip file." << endl;
+        return -1;
+      }
+    }
+    return size - stream -> avail_out;
+  }
+#endif
+
+#ifdef HAVE_ZSTD
+  if(compression == ZSTDFILE) {
+    ZSTD_outBuffer output = {dest, (size_t) size, 0};
+    ZSTD_inBuffer input;
+    size_t state;
+    bool last = false;
+
+    /* Feed the decoder until it gives back some data. Once the input file is
+     * over, it is still called to flush data kept inside the decoder */
+    while(output.pos == 0) {
+      if(packedBegin == packedEnd) {
+        do {
+          bytes = read(fd, packed, packedSize);
+        } while((bytes == -1) && (errno == EINTR));
+
+        if(bytes == -1)
+          return -1;
+        packedBegin = 0;
+        packedEnd = bytes;
+        last = (bytes == 0);
+      }
+
+      input.src = packed;
+      input.size = packedEnd;
+      input.pos = packedBegin;
+
+      state = ZSTD_decompressStream((ZSTD_DStream *) decoder, &output, &input);
+      if(ZSTD_isError(state)) {
+        cerr << endl << "ERROR: Input file is not a valid zstd file." << endl;
+        return -1;
+      }
+      packedBegin = input.pos;
+
+      /* A zero means a frame has been completely decoded and flushed */
+      if(state == 0)
+        unfinished = false;
+      else if((input.size != 0) || (output.pos != 0))
+        unfinished = true;
+
+      /* Input file is over. It is an error in the middle of a frame */
+      if(last) {
+        if((output.pos == 0) && (unfinished)) {
+          cerr << endl << "ERROR: Input file is not a valid zstd file." << endl;
+          return -1;
+        }
+        break;
+      }
+    }
+    return output.pos;
+  }
+#endif
+
+  do {
+    bytes = read(fd, dest, size);
+  } while((bytes == -1) && (errno == EINTR));
+
+  return bytes;
+}
+
+bool lineReader::fill(void) {
+  /* Move unread data to the buffer beginning and read a new chunk after it.
+   * If the buffer is full of unread data, i.e. very long lines, double its
+   * size, so data is copied a few times even for huge lines or when the whole
+   * file is held in memory. File beginning is kept in place while it is still
+   * intact */
+  char *tmp;
+  long bytes;
+
+  if(exhausted)
+    return false;
+
+  if((begin != 0) && (!intact)) {
+    memmove(buffer, buffer + begin, end - begin);
+    end -= begin;
+    begin = 0;
+  }
+
+  if(end == capacity - 1) {
+    tmp = (char *) realloc(buffer, 2 * end + 1);
+    if(tmp == NULL) {
+      cerr << endl << "ERROR: Not enough memory to read the input file." << endl;
+      exhausted = true;
+      return false;
+    }
+    buffer = tmp;
+    capacity = 2 * end + 1;
+  }
+
+  bytes = readSource(buffer + end, capacity - end - 1);
+  if(bytes <= 0) {
+    exhausted = true;
+    return false;
+  }
+
+  end += bytes;
+  return true;
+}
+
+bool lineReader::nextLine(char *&line, char *&last) {
+  /* Get next line limits, reading new chunks while its end is not found */
+  char *nline;
+  long searched = 0;
+
+  /* Check it the end of the file has been reached or not */
+  if(endOfFile)
+    return false;
+
+  /* Look for the line end. Read a new chunk while it is not found */
+  while(((nline = (char *) memchr(buffer + begin + searched, '\n',
+    end - begin - searched)) == NULL) && (!exhausted)) {
+    searched = end - begin;
+    fill();
+  }
+
+  line = buffer + begin;
+  if(nline != NULL) {
+    last = nline;
+    begin = nline - buffer + 1;
+  } else {
+    last = buffer + end;
+    begin = end;
+    endOfFile = true;
+  }
+  return true;
+}
+
+static char *cleanLine(char *line, char *last) {
+  /* Line content is modified in place: the new line character is replaced by
+   * a string end and carriage returns as well as blank spaces and tabs at the
+   * line beginning are removed */
+  char *nline, *ptr;
+
+  *last = '\0';
+
+  /* For -Windows & MacOS compatibility- carriage returns are removed */
+  if((ptr = (char *) memchr(line, '\r', last - line)) != NULL) {
+    for(nline = ptr; ptr < last; ptr++)
+      if(*ptr != '\r')
+        *nline++ = *ptr;
+    last = nline;
+    *last = '\0';
+  }
+
+  /* Remove blank spaces & tabs from the beginning of the line */
+  while(*line == ' ')
+    line++;
+  while(*line == '\t')
+    line++;
+
+  /* If there is nothing to return, give back a NULL pointer */
+  if(line == last)
+    return NULL;
+
+  return line;
+}
+
+char *lineReader::readLine(void) {
+  /* Get next line from input file. It is cleaned inside the buffer */
+  char *line, *last;
+
+  if(!nextLine(line, last))
+    return NULL;
+
+  intact = false;
+  return cleanLine(line, last);
+}
+
+char *lineReader::peekLine(void) {
+  /* Get next line from input file. It is cleaned over a copy, so the buffer
+   * content does not change */
+  char *line, *last;
+  long length;
+
+  if(!nextLine(line, last))
+    return NULL;
+
+  length = last - line;
+  if(length + 1 > copySize) {
+    delete [] copy;
+    copySize = length + 1;
+    copy = new char[copySize];
+  }
+  memcpy(copy, line, length);
+
+  return cleanLine(copy, copy + length);
+}
+
+char *lineReader::scanLine(void) {
+  /* Get next line from input file for a pass followed by a rewind. Holding
+   * the whole file in memory is only needed when it can not be read again */
+  if(seekable)
+    return readLine();
+  return peekLine();
+}
+
+bool lineReader::readChar(char &c) {
+  /* Get next character from input file */
+  if((begin == end) && (!fill())) {
+    endOfFile = true;
+    return false;
+  }
+
+  c = buffer[begin++];
+  return true;
+}
+
+bool lineReader::eof(void) {
+  return endOfFile;
+}
+
+void lineReader::rewind(void) {
+  /* Move input file pointer to the beginning and discard buffered data */
+  if(fd == -1)
+    return;
+
+  /* File beginning is still in the buffer */
+  if(intact) {
+    begin = 0;
+    endOfFile = false;
+    return;
+  }
+
+#ifdef HAVE_ZLIB
+  if(compression == GZIPFILE)
+    inflateReset((z_stream *) decoder);
+#endif
+
+#ifdef HAVE_ZSTD
+  if(compression == ZSTDFILE)
+    ZSTD_initDStream((ZSTD_DStream *) decoder);
+#endif
+
+  /* Pipes can not go back, parsers only do it while the file beginning is
+   * still in the buffer */
+  lseek(fd, 0, SEEK_SET);
+  packedBegin = 0;
+  packedEnd = 0;
+  unfinished = false;
+
+  begin = 0;
+  end = 0;
+  exhausted = false;
+  endOfFile = false;
+  intact = true;
+}
+
+int lineReader::getDescriptor(void) {
+  return fd;
+}
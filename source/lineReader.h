@@ -0,0 +1,141 @@
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+   ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+
+    trimAl v1.4: a tool for automated alignment trimming in large-scale
+                 phylogenetics analyses.
+
+    2009-2015 Capella-Gutierrez S. and Gabaldon, T.
+              [scapella, tgabaldon]@crg.es
+
+    This file is part of trimAl
+
+    trimAl is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, the last available version.
+
+    trimAl is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with trimAl. If not, see <http://www.gnu.org/licenses/>.
+
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+
+#ifndef LINEREADER_H
+#define LINEREADER_H
+
+#include <stdlib.h>
+
+#include "defines.h"
+
+using namespace std;
+
+/* ***************************************************************************************************************** */
+/*                                           Header Class File: lineReader.                                          */
+/* ***************************************************************************************************************** */
+
+/* Block-buffered input file reader. Input file is read in large chunks and
+ * lines are given back as pointers to the reader internal buffer, trimmed in
+ * place, without any further copy or memory allocation. Files compressed
+ * with gzip or zstd are detected by their magic numbers and decompressed on
+ * the fly, so parsers always see plain text. Lines can also be peeked at
+ * without changing the buffer: while that is the only way the file has been
+ * read, going back to its beginning does not need to read it again */
+
+class lineReader {
+
+  int fd;
+  int compression;
+
+  char *buffer;
+  long capacity;
+  long begin;
+  long end;
+
+  bool exhausted;
+  bool endOfFile;
+
+  /* Buffer keeps the file beginning without any change */
+  bool intact;
+
+  /* Input is a plain regular file, so it can be read again from disk */
+  bool seekable;
+
+  /* Copy of the last peeked line */
+  char *copy;
+  long copySize;
+
+  /* Decompression stream and compressed data waiting to be decoded */
+  void *decoder;
+  char *packed;
+  long packedSize;
+  long packedBegin;
+  long packedEnd;
+
+  /* Decoder is in the middle of a compressed frame */
+  bool unfinished;
+
+  /* Set-up decompression stream for current input file */
+  bool openDecoder(void);
+
+  /* Get up to the given number of plain bytes from the input file */
+  long readSource(char *, long);
+
+  /* Read a new chunk from the input file keeping unread data */
+  bool fill(void);
+
+  /* Locate next line limits inside the buffer */
+  bool nextLine(char *&, char *&);
+
+ public:
+
+  /* Class constructor without parameters. */
+  lineReader(void);
+
+  /* Class destroyer. */
+  ~lineReader(void);
+
+  /* Open the given file, "-" for the standard input. It returns false if
+   * the file does not exist or it is empty */
+  bool open(const char *);
+
+  /* Close current input file */
+  void close(void);
+
+  /* Read a new line. Carriage returns are removed as well as blank spaces and
+   * tabs at the line beginning. It returns NULL for empty lines and once the
+   * end of file has been reached. Returned line is valid until next call */
+  char *readLine(void);
+
+  /* Same as readLine but the line is a copy, so the buffer is not changed */
+  char *peekLine(void);
+
+  /* Read a line in a pass the parser will rewind afterwards. Plain regular
+   * files are read with readLine and sought back, while pipes and compressed
+   * streams are peeked at to be kept in memory until the rewind */
+  char *scanLine(void);
+
+  /* Read a single character. It returns false at the end of file */
+  bool readChar(char &);
+
+  /* Return true once any read operation has reached the end of file */
+  bool eof(void);
+
+  /* Move back to the input file beginning. File is not read again if it has
+   * only been accessed using peekLine and readChar, which is the only way
+   * to go back on pipes */
+  void rewind(void);
+
+  /* Return input file descriptor to share it with other readers */
+  int getDescriptor(void);
+
+  /* Return input file compression: PLAINFILE, GZIPFILE or ZSTDFILE */
+  int getCompression(void);
+
+  /* Guess compression format from the first bytes of a file */
+  static int detectCompression(const char *, long);
+};
+#endif
@@ -27,16 +27,38 @@
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <mutex>
+#include <set>
 
 #include <stdlib.h>
 #include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 #include "compareFiles.h"
 #include "compareFiles.h"
 #include "alignment.h"
+#include "threadPool.h"
 #include "defines.h"
 #include "utils.h"
 
+/* Trimming methods and parameters given by the user. They are applied in
+ * the same way to a single alignment or to every alignment in batch mode */
+struct trimmingOptions {
+  bool complementary, nogaps, noallgaps, gappyout, strict, strictplus, automated1, selectCols, selectSeqs,
+       terminal, keepSeqs, keepHeader, shortNames;
+
+  float conserve, gapThreshold, simThreshold, comThreshold, resOverlap, seqOverlap, maxIdentity;
+
+  int outformat, gapWindow, simWindow, blockSize, clusters, alternative_matrix, *delColumns, *delSequences, *boundaries;
+
+  char *matrix;
+};
+
+alignment *trimAlignment(alignment *, trimmingOptions &, float *, bool &);
+bool batchTrimming(char *, char *, trimmingOptions &);
+
 void menu(void);
 void examples(void);
 
@@ -46,7 +68,7 @@ int main(int argc, char *argv[]){
   bool appearErrors = false, complementary = false, colnumbering = false, nogaps = false, noallgaps = false, gappyout = false,
        strict = false, strictplus = false, automated1 = false, sgc = false, sgt = false, scc = false, sct = false, sfc = false,
        sft = false, sident = false, soverlap = false, selectSeqs = false, selectCols = false, shortNames = false, splitbystop = false,
-       terminal = false, keepSeqs = false, keepHeader = false, ignorestop = false;
+       terminal = false, keepSeqs = false, keepHeader = false, ignorestop = false, compactIdentity = false;
 
   float conserve = -1, gapThreshold = -1, simThreshold = -1, comThreshold = -1, resOverlap = -1, seqOverlap = -1, maxIdentity = -1;
 
@@ -60,11 +82,13 @@ int main(int argc, char *argv[]){
   string nline, *seqNames = NULL;
   sequencesMatrix *seqMatrix = NULL;
   similarityMatrix *similMatrix = NULL;
-  alignment *origAlig = NULL, *intermediateAlig = NULL, *singleAlig = NULL, *backtranslation = NULL;
+  alignment *origAlig = NULL, *singleAlig = NULL, *backtranslation = NULL;
 
-  int i = 1, lng, num = 0, maxAminos = 0, numfiles = 0, referFile = 0, *delColumns = NULL, *delSequences = NULL, *seqLengths = NULL, *boundaries = NULL;
+  int i = 1, lng, num = 0, maxAminos = 0, numfiles = 0, referFile = 0, threads = -1, approxCons = -1, *delColumns = NULL, *delSequences = NULL, *seqLengths = NULL, *boundaries = NULL;
   char c, *forceFile = NULL, *infile = NULL, *backtransFile = NULL, *outfile = NULL, *outhtml = NULL, *matrix = NULL,
-       **filesToCompare = NULL, line[256];
+       **filesToCompare = NULL, line[256], *batchFile = NULL, *outdir = NULL;
+
+  trimmingOptions options;
 
   /* ------------------------------------------------------------------------------------------------------ */
 
@@ -146,6 +170,55 @@ int main(int argc, char *argv[]){
       strcpy(outhtml, argv[i]);
     }
 
+   /* Option -batch ---------------------------------------------------------------------------------- */
+    else if((!strcmp(argv[i], "-batch")) && (i+1 != argc) && (batchFile == NULL)) {
+      lng = strlen(argv[++i]);
+      batchFile = new char[lng + 1];
+      strcpy(batchFile, argv[i]);
+    }
+
+   /* Option -outdir --------------------------------------------------------------------------------- */
+    else if((!strcmp(argv[i], "-outdir")) && (i+1 != argc) && (outdir == NULL)) {
+      lng = strlen(argv[++i]);
+      outdir = new char[lng + 1];
+      strcpy(outdir, argv[i]);
+    }
+
+   /* Option -threads -------------------------------------------------------------------------------- */
+    else if((!strcmp(argv[i], "-threads")) && (i+1 != argc) && (threads == -1)) {
+      if(utils::isNumber(argv[i+1])) {
+        threads = atoi(argv[++i]);
+        if(threads < 1) {
+          cerr << endl << "ERROR: The number of threads should be a positive integer." << endl << endl;
+          appearErrors = true;
+        }
+      }
+      else {
+        cerr << endl << "ERROR: The number of threads should be a positive integer." << endl << endl;
+        appearErrors = true;
+      }
+    }
+
+   /* Option -compactidentity ------------------------------------------------------------------------ */
+    else if((!strcmp(argv[i], "-compactidentity")) && (!compactIdentity)) {
+      compactIdentity = true;
+    }
+
+   /* Option -approx_cons ---------------------------------------------------------------------------- */
+    else if((!strcmp(argv[i], "-approx_cons")) && (i+1 != argc) && (approxCons == -1)) {
+      if(utils::isNumber(argv[i+1])) {
+        approxCons = atoi(argv[++i]);
+        if(approxCons < 2) {
+          cerr << endl << "ERROR: The number of sampled pairs should be an integer greater than 1." << endl << endl;
+          appearErrors = true;
+        }
+      }
+      else {
+        cerr << endl << "ERROR: The number of sampled pairs should be an integer greater than 1." << endl << endl;
+        appearErrors = true;
+      }
+    }
+
    /* ------------------------------------------------------------------------------------------------------ */
 
    /*                                           Output File format                                           */
@@ -1156,6 +1229,34 @@ int main(int argc, char *argv[]){
    /*                                       Postprocessing Parameters                                        */
 
 
+  /* ------------------------------------------------------------------------------------------------------ */
+  if((!appearErrors) && (batchFile != NULL)) {
+    if((infile != NULL) || (compareset != -1) || (forceFile != NULL) || (backtransFile != NULL)) {
+      cerr << endl << "ERROR: Batch mode can not be used with any other input file." << endl << endl;
+      appearErrors = true;
+    }
+    else if((outfile != NULL) || (outhtml != NULL) || (colnumbering) || (stats < 0) || (comThreshold != -1)) {
+      cerr << endl << "ERROR: Batch mode only allows trimming methods and output formats. "
+           << "Output files are written into the output directory." << endl << endl;
+      appearErrors = true;
+    }
+    else if(outdir == NULL) {
+      cerr << endl << "ERROR: An output directory should be defined in batch mode." << endl << endl;
+      appearErrors = true;
+    }
+  }
+  /* ------------------------------------------------------------------------------------------------------ */
+  if((!appearErrors) && (threads != -1))
+    threadPool::setSharedThreads(threads);
+  if((!appearErrors) && (compactIdentity))
+    identityMatrix::setCompact(true);
+  if((!appearErrors) && (approxCons != -1))
+    statisticsConservation::setSamples(approxCons);
+  /* ------------------------------------------------------------------------------------------------------ */
+  if((!appearErrors) && (batchFile == NULL) && (outdir != NULL)) {
+     cerr << endl << "ERROR: The output directory can only be used in batch mode." << endl << endl;
+     appearErrors = true;
+  }
   /* ------------------------------------------------------------------------------------------------------ */
   if((!appearErrors) && (infile != NULL) && (forceFile != NULL)) {
      cerr << endl << "ERROR: You can not use a single alignmet at the same "
@@ -1225,7 +1326,7 @@ int main(int argc, char *argv[]){
       appearErrors = true;
     }
 
-    else if(boundaries[1] >= num) {
+    else if((batchFile == NULL) && (boundaries[1] >= num)) {
       cerr << endl << "ERROR:  \"--set_boundaries\" parameter only accepts "
         << "integer numbers between 0 and the number of positions (" << num
         << ") - 1." << endl << endl;
@@ -1410,7 +1511,7 @@ int main(int argc, char *argv[]){
   /* **** ***** ***** ***** ***** ***** **** **************************** **** ***** ***** ***** ***** ***** **** */
 
   /* ------------------------------------------------------------------------------------------------------ */
-  if((!appearErrors) && (origAlig -> getNumAminos() < (blockSize/4))) {
+  if((!appearErrors) && (batchFile == NULL) && (origAlig -> getNumAminos() < (blockSize/4))) {
      cerr << endl << "ERROR: The block size value is too big. Please, choose another one smaller than residues number / 4." << endl << endl;
      appearErrors = true;
   }
@@ -1477,6 +1578,9 @@ int main(int argc, char *argv[]){
     delete[] infile;
     delete[] matrix;
 
+    delete[] batchFile;
+    delete[] outdir;
+
     if(forceFile != NULL) delete forceFile;
     if(backtransFile != NULL) delete backtransFile;
     if(backtranslation != NULL) delete backtranslation;
@@ -1490,10 +1594,6 @@ int main(int argc, char *argv[]){
     conserve  = 0;
   /* -------------------------------------------------------------------- */
 
-  origAlig -> trimTerminalGaps(terminal, boundaries);
-  origAlig -> setKeepSequencesFlag(keepSeqs);
-  origAlig -> setKeepSeqsHeaderFlag(keepHeader);
-
   /* -------------------------------------------------------------------- */
   if(windowSize != -1) {
     gapWindow = windowSize;
@@ -1505,6 +1605,44 @@ int main(int argc, char *argv[]){
     if(simWindow == -1)
       simWindow = 0;
   }
+  /* -------------------------------------------------------------------- */
+
+  /* -------------------------------------------------------------------- */
+  options.complementary = complementary; options.nogaps = nogaps; options.noallgaps = noallgaps;
+  options.gappyout = gappyout; options.strict = strict; options.strictplus = strictplus;
+  options.automated1 = automated1; options.selectCols = selectCols; options.selectSeqs = selectSeqs;
+  options.terminal = terminal; options.keepSeqs = keepSeqs; options.keepHeader = keepHeader;
+  options.shortNames = shortNames;
+
+  options.conserve = conserve; options.gapThreshold = gapThreshold; options.simThreshold = simThreshold;
+  options.comThreshold = comThreshold; options.resOverlap = resOverlap; options.seqOverlap = seqOverlap;
+  options.maxIdentity = maxIdentity;
+
+  options.outformat = outformat; options.gapWindow = gapWindow; options.simWindow = simWindow;
+  options.blockSize = blockSize; options.clusters = clusters; options.alternative_matrix = alternative_matrix;
+  options.delColumns = delColumns; options.delSequences = delSequences; options.boundaries = boundaries;
+  options.matrix = matrix;
+  /* -------------------------------------------------------------------- */
+
+  /* -------------------------------------------------------------------- */
+  if(batchFile != NULL) {
+    appearErrors = !batchTrimming(batchFile, outdir, options);
+
+    delete origAlig;
+    delete []delColumns;
+    delete []delSequences;
+
+    delete[] batchFile;
+    delete[] outdir;
+    delete[] matrix;
+
+    return appearErrors ? -1 : 0;
+  }
+  /* -------------------------------------------------------------------- */
+
+  origAlig -> trimTerminalGaps(terminal, boundaries);
+  origAlig -> setKeepSequencesFlag(keepSeqs);
+  origAlig -> setKeepSeqsHeaderFlag(keepHeader);
   origAlig -> setWindowsSize(gapWindow, simWindow);
 
   /* -------------------------------------------------------------------- */
@@ -1609,37 +1747,115 @@ int main(int argc, char *argv[]){
   /* -------------------------------------------------------------------- */
 
   /* -------------------------------------------------------------------- */
-  if(nogaps)
-    singleAlig = origAlig -> cleanGaps(0, 0, complementary);
+  singleAlig = trimAlignment(origAlig, options, compareVect, appearErrors);
+  /* -------------------------------------------------------------------- */
 
-  else if(noallgaps)
-    singleAlig = origAlig -> cleanNoAllGaps(complementary);
+  /* -------------------------------------------------------------------- */
+  if(singleAlig == NULL) {
+    singleAlig = origAlig;
+    origAlig = NULL;
+  }
+  /* -------------------------------------------------------------------- */
 
-  else if(gappyout)
-    singleAlig = origAlig -> clean2ndSlope(complementary);
+  /* -------------------------------------------------------------------- */
+  if((outhtml != NULL) && (!appearErrors))
+    if(!origAlig -> alignmentSummaryHTML(outhtml, singleAlig -> getNumAminos(), singleAlig -> getNumSpecies(),
+                                     singleAlig -> getCorrespResidues(), singleAlig -> getCorrespSequences(), compareVect)) {
+      cerr << endl << "ERROR: It's imposible to generate the HTML output file." << endl << endl;
+      appearErrors = true;
+    }
+  /* -------------------------------------------------------------------- */
 
-  else if(strict)
-    singleAlig = origAlig -> cleanCombMethods(complementary, false);
+  /* -------------------------------------------------------------------- */
+  if(backtransFile != NULL) {
 
-  else if(strictplus)
-    singleAlig = origAlig -> cleanCombMethods(complementary, true);
+  if(seqNames != NULL) delete [] seqNames;
+    seqNames = new string[singleAlig -> getNumSpecies()];
+
+  singleAlig -> getSequences(seqNames);
 
-  else if(automated1) {
+  singleAlig = backtranslation -> getTranslationCDS(singleAlig -> getNumAminos(), singleAlig -> getNumSpecies(),
+                                                      singleAlig -> getCorrespResidues(), seqNames, seqMatrix, singleAlig);
+  }
+  /* -------------------------------------------------------------------- */
+
+  /* -------------------------------------------------------------------- */
+  if((outfile != NULL) && (!appearErrors)) {
+    if(!singleAlig -> saveAlignment(outfile)) {
+      cerr << endl << "ERROR: It's imposible to generate the output file." << endl << endl;
+      appearErrors = true;
+    }
+  }
+  else if((stats >= 0) && (!appearErrors))
+    singleAlig -> printAlignment();
+  /* -------------------------------------------------------------------- */
+
+  /* -------------------------------------------------------------------- */
+  if((colnumbering) && (!appearErrors))
+    singleAlig -> printCorrespondence();
+  /* -------------------------------------------------------------------- */
+
+  /* -------------------------------------------------------------------- */
+  delete singleAlig;
+  delete origAlig;
+    
+  delete[] compAlig;
+
+  delete similMatrix;
+  delete []delColumns;
+
+  delete[] filesToCompare;
+  delete[] compareVect;
+
+  delete[] outfile;
+  delete[] outhtml;
+
+  delete[] infile;
+  delete[] matrix;
+  /* -------------------------------------------------------------------- */
+
+  return 0;
+}
+
+/* Apply the trimming methods selected by the user to the given alignment.
+ * It returns NULL when no method produces a new alignment */
+alignment *trimAlignment(alignment *origAlig, trimmingOptions &options, float *compareVect, bool &appearErrors) {
+
+  alignment *singleAlig = NULL, *intermediateAlig = NULL;
+  int i, num;
+
+  /* -------------------------------------------------------------------- */
+  if(options.nogaps)
+    singleAlig = origAlig -> cleanGaps(0, 0, options.complementary);
+
+  else if(options.noallgaps)
+    singleAlig = origAlig -> cleanNoAllGaps(options.complementary);
+
+  else if(options.gappyout)
+    singleAlig = origAlig -> clean2ndSlope(options.complementary);
+
+  else if(options.strict)
+    singleAlig = origAlig -> cleanCombMethods(options.complementary, false);
+
+  else if(options.strictplus)
+    singleAlig = origAlig -> cleanCombMethods(options.complementary, true);
+
+  else if(options.automated1) {
     if(origAlig -> selectMethod() == GAPPYOUT)
-      singleAlig = origAlig -> clean2ndSlope(complementary);
+      singleAlig = origAlig -> clean2ndSlope(options.complementary);
     else
-      singleAlig = origAlig -> cleanCombMethods(complementary, false);
+      singleAlig = origAlig -> cleanCombMethods(options.complementary, false);
   }
   /* -------------------------------------------------------------------- */
 
   /* -------------------------------------------------------------------- */
-  if(comThreshold != -1)
-    singleAlig = origAlig -> cleanCompareFile(comThreshold, conserve, compareVect, complementary);
+  if(options.comThreshold != -1)
+    singleAlig = origAlig -> cleanCompareFile(options.comThreshold, options.conserve, compareVect, options.complementary);
  /* -------------------------------------------------------------------- */
 
   /* -------------------------------------------------------------------- */
-  if((resOverlap != -1) && (seqOverlap != -1)) {
-    intermediateAlig = origAlig -> cleanSpuriousSeq(resOverlap, (seqOverlap/100), complementary);
+  if((options.resOverlap != -1) && (options.seqOverlap != -1)) {
+    intermediateAlig = origAlig -> cleanSpuriousSeq(options.resOverlap, (options.seqOverlap/100), options.complementary);
     singleAlig = intermediateAlig -> cleanNoAllGaps(false);
     
     delete intermediateAlig;
@@ -1647,21 +1863,21 @@ int main(int argc, char *argv[]){
   /* -------------------------------------------------------------------- */
 
   /* -------------------------------------------------------------------- */
-  if(simThreshold != -1.0) {
-    if(gapThreshold != -1.0)
-      singleAlig = origAlig -> clean(conserve, gapThreshold, simThreshold, complementary);
+  if(options.simThreshold != -1.0) {
+    if(options.gapThreshold != -1.0)
+      singleAlig = origAlig -> clean(options.conserve, options.gapThreshold, options.simThreshold, options.complementary);
     else
-      singleAlig = origAlig -> cleanConservation(conserve, simThreshold, complementary);
+      singleAlig = origAlig -> cleanConservation(options.conserve, options.simThreshold, options.complementary);
   }
   /* -------------------------------------------------------------------- */
 
   /* -------------------------------------------------------------------- */
-  else if(gapThreshold != -1.0)
-    singleAlig = origAlig -> cleanGaps(conserve, gapThreshold, complementary);
+  else if(options.gapThreshold != -1.0)
+    singleAlig = origAlig -> cleanGaps(options.conserve, options.gapThreshold, options.complementary);
   /* -------------------------------------------------------------------- */
 
   /* -------------------------------------------------------------------- */
-  if((selectCols) || (selectSeqs)) {
+  if((options.selectCols) || (options.selectSeqs)) {
 
     /* Columns and/or sequences to be removed might be disordered. Therefore,
      * we cannot assume the last element of the vectors are the highest ones.
@@ -1669,11 +1885,11 @@ int main(int argc, char *argv[]){
      * established boundaries e.g. max number of sequences and/or columns.
      */
     
-    if(delColumns != NULL) {
+    if(options.delColumns != NULL) {
       num = origAlig -> getNumAminos();
 
-      for(i = 1; i < delColumns[0] + 1; i++) 
-        if(delColumns[i] >= num) {
+      for(i = 1; i < options.delColumns[0] + 1; i++) 
+        if(options.delColumns[i] >= num) {
           cerr << endl << "ERROR: This option only accepts integer numbers "
               "between 0 and the number of columns - 1." << endl << endl;
           appearErrors = true;
@@ -1681,16 +1897,16 @@ int main(int argc, char *argv[]){
         }
 
       if (!appearErrors)
-        singleAlig = origAlig -> removeColumns(delColumns, 1, delColumns[0], \
-          complementary);
+        singleAlig = origAlig -> removeColumns(options.delColumns, 1, options.delColumns[0], \
+          options.complementary);
 
     }
 
-    if(delSequences != NULL) {
+    if(options.delSequences != NULL) {
       num = origAlig -> getNumSpecies();
 
-      for(i = 1; i < delSequences[0] + 1; i++) 
-        if(delSequences[i] >= num) {
+      for(i = 1; i < options.delSequences[0] + 1; i++) 
+        if(options.delSequences[i] >= num) {
           cerr << endl << "ERROR: This option only accepts integer numbers "
               "between 0 and the number of sequences - 1." << endl << endl;
           appearErrors = true;
@@ -1698,8 +1914,8 @@ int main(int argc, char *argv[]){
         }
         
       if (!appearErrors) {
-        intermediateAlig = origAlig -> removeSequences(delSequences, 1, \
-          delSequences[0], complementary);
+        intermediateAlig = origAlig -> removeSequences(options.delSequences, 1, \
+          options.delSequences[0], options.complementary);
         singleAlig = intermediateAlig -> cleanNoAllGaps(false);
         
         delete intermediateAlig;
@@ -1709,18 +1925,18 @@ int main(int argc, char *argv[]){
   /* -------------------------------------------------------------------- */
 
   /* -------------------------------------------------------------------- */
-  if(maxIdentity != -1) {
-    intermediateAlig = origAlig -> getClustering(maxIdentity);
+  if(options.maxIdentity != -1) {
+    intermediateAlig = origAlig -> getClustering(options.maxIdentity);
     singleAlig = intermediateAlig -> cleanNoAllGaps(false);
     
     delete intermediateAlig;  
   }
-  else if(clusters != -1) {
-  if(clusters > origAlig -> getNumSpecies()) {
+  else if(options.clusters != -1) {
+  if(options.clusters > origAlig -> getNumSpecies()) {
         cerr << endl << "ERROR:The number of clusters from the alignment can not be larger than the number of sequences from that alignment." << endl << endl;
         appearErrors = true;
     } else {
-    intermediateAlig = origAlig -> getClustering(origAlig -> getCutPointClusters(clusters));
+    intermediateAlig = origAlig -> getClustering(origAlig -> getCutPointClusters(options.clusters));
     singleAlig = intermediateAlig -> cleanNoAllGaps(false);
     
     delete intermediateAlig;
@@ -1728,71 +1944,261 @@ int main(int argc, char *argv[]){
   }
   /* -------------------------------------------------------------------- */
 
-  /* -------------------------------------------------------------------- */
-  if(singleAlig == NULL) {
-    singleAlig = origAlig;
-    origAlig = NULL;
+
+  return singleAlig;
+}
+
+/* Data shared by the tasks trimming every alignment in batch mode */
+struct batchJob {
+  trimmingOptions *options;
+  char *outdir;
+
+  char **files;
+  long *sizes;
+  int *order;
+  string *summary;
+  bool *failed;
+
+  /* One similarity matrix for each alignment datatype */
+  mutex lock;
+  similarityMatrix *matrices[RNADeg + 1];
+};
+
+struct largerBatchFile {
+  /* Largest files go first. Ties keep the order in the input list */
+  long *sizes;
+
+  bool operator()(int i, int j) const {
+    if(sizes[i] != sizes[j])
+      return sizes[i] > sizes[j];
+    return i < j;
   }
-  /* -------------------------------------------------------------------- */
+};
 
-  /* -------------------------------------------------------------------- */
-  if((outhtml != NULL) && (!appearErrors))
-    if(!origAlig -> alignmentSummaryHTML(outhtml, singleAlig -> getNumAminos(), singleAlig -> getNumSpecies(),
-                                     singleAlig -> getCorrespResidues(), singleAlig -> getCorrespSequences(), compareVect)) {
-      cerr << endl << "ERROR: It's imposible to generate the HTML output file." << endl << endl;
-      appearErrors = true;
-    }
-  /* -------------------------------------------------------------------- */
+static similarityMatrix *batchSimilarityMatrix(batchJob *job, int dataType) {
+  /* Similarity matrices are built once and shared by every alignment with
+   * the same datatype. A user-defined matrix is used for all of them */
+  trimmingOptions *options = job -> options;
+  int slot = (options -> matrix != NULL) ? 0 : dataType;
 
-  /* -------------------------------------------------------------------- */
-  if(backtransFile != NULL) {
+  lock_guard<mutex> guard(job -> lock);
 
-  if(seqNames != NULL) delete [] seqNames;
-    seqNames = new string[singleAlig -> getNumSpecies()];
+  if(job -> matrices[slot] == NULL) {
+    job -> matrices[slot] = new similarityMatrix();
 
-  singleAlig -> getSequences(seqNames);
+    if(options -> matrix != NULL)
+      job -> matrices[slot] -> loadSimMatrix(options -> matrix);
 
-  singleAlig = backtranslation -> getTranslationCDS(singleAlig -> getNumAminos(), singleAlig -> getNumSpecies(),
-                                                      singleAlig -> getCorrespResidues(), seqNames, seqMatrix, singleAlig);
+    else if(options -> alternative_matrix != -1)
+      job -> matrices[slot] -> alternativeSimilarityMatrices(options -> alternative_matrix, dataType);
+
+    else if(dataType == AAType)
+      job -> matrices[slot] -> defaultAASimMatrix();
+    else if((dataType == DNAType) || (dataType == RNAType))
+      job -> matrices[slot] -> defaultNTSimMatrix();
+    else if((dataType == DNADeg) || (dataType == RNADeg))
+      job -> matrices[slot] -> defaultNTDegeneratedSimMatrix();
   }
-  /* -------------------------------------------------------------------- */
+  return job -> matrices[slot];
+}
 
-  /* -------------------------------------------------------------------- */
-  if((outfile != NULL) && (!appearErrors)) {
-    if(!singleAlig -> saveAlignment(outfile)) {
-      cerr << endl << "ERROR: It's imposible to generate the output file." << endl << endl;
-      appearErrors = true;
+static void trimBatchFile(int task, void *data) {
+  /* Trim one of the alignments in batch mode and keep a summary line */
+  batchJob *job = (batchJob *) data;
+  trimmingOptions &options = *(job -> options);
+  alignment *origAlig, *singleAlig = NULL;
+  const char *status = "ok", *name;
+  bool appearErrors = false, trimming;
+  string outfile;
+  int n = job -> order[task], species = 0, aminos = 0;
+
+  trimming = (options.nogaps) || (options.noallgaps) || (options.gappyout) || (options.strict) ||
+    (options.strictplus) || (options.automated1) || (options.gapThreshold != -1) || (options.simThreshold != -1) ||
+    (options.selectCols) || (options.selectSeqs) || (options.resOverlap != -1) || (options.seqOverlap != -1) ||
+    (options.maxIdentity != -1) || (options.clusters != -1);
+
+  /* Output file gets the input file name inside the output directory */
+  name = strrchr(job -> files[n], '/');
+  name = (name == NULL) ? job -> files[n] : name + 1;
+  outfile = job -> outdir;
+  outfile += "/";
+  outfile += name;
+
+  origAlig = new alignment;
+  if(!origAlig -> loadAlignment(job -> files[n]))
+    status = "not_loaded";
+
+  else if((trimming) && (!origAlig -> isFileAligned()))
+    status = "not_aligned";
+
+  else if(origAlig -> getNumAminos() < (options.blockSize/4))
+    status = "block_size";
+
+  else if((options.terminal) && (options.boundaries != NULL) && (options.boundaries[1] >= origAlig -> getNumAminos()))
+    status = "boundaries";
+
+  else {
+    species = origAlig -> getNumSpecies();
+    aminos = origAlig -> getNumAminos();
+
+    origAlig -> trimTerminalGaps(options.terminal, options.boundaries);
+    origAlig -> setKeepSequencesFlag(options.keepSeqs);
+    origAlig -> setKeepSeqsHeaderFlag(options.keepHeader);
+    origAlig -> setWindowsSize(options.gapWindow, options.simWindow);
+
+    if(options.blockSize != -1)
+      origAlig -> setBlockSize(options.blockSize);
+
+    if(options.outformat != -1)
+      origAlig -> setOutputFormat(options.outformat, options.shortNames);
+
+    if(((options.strict) || (options.strictplus) || (options.automated1) || (options.simThreshold != -1.0)) &&
+      (!origAlig -> setSimilarityMatrix(batchSimilarityMatrix(job, origAlig -> getTypeAlignment()))))
+      status = "similarity_matrix";
+
+    else {
+      singleAlig = trimAlignment(origAlig, options, NULL, appearErrors);
+      if(singleAlig == NULL) {
+        singleAlig = origAlig;
+        origAlig = NULL;
+      }
+
+      if(appearErrors)
+        status = "trimming";
+      else if(!singleAlig -> saveAlignment((char *) outfile.c_str()))
+        status = "not_saved";
     }
   }
-  else if((stats >= 0) && (!appearErrors))
-    singleAlig -> printAlignment();
-  /* -------------------------------------------------------------------- */
 
-  /* -------------------------------------------------------------------- */
-  if((colnumbering) && (!appearErrors))
-    singleAlig -> printCorrespondence();
-  /* -------------------------------------------------------------------- */
+  /* Summary line: input and output sequences and columns numbers */
+  job -> failed[n] = (strcmp(status, "ok") != 0);
+  job -> summary[n] = job -> files[n];
+  job -> summary[n] += "\t";
+  job -> summary[n] += status;
 
-  /* -------------------------------------------------------------------- */
-  delete singleAlig;
+  if(!job -> failed[n])
+    job -> summary[n] += "\t" + to_string(species) + "\t" + to_string(aminos) + "\t" +
+      to_string(singleAlig -> getNumSpecies()) + "\t" + to_string(singleAlig -> getNumAminos()) + "\t" + outfile;
+  else
+    job -> summary[n] += "\t-\t-\t-\t-\t-";
+
+  if(singleAlig != origAlig)
+    delete singleAlig;
   delete origAlig;
-    
-  delete[] compAlig;
+}
 
-  delete similMatrix;
-  delete []delColumns;
+/* Apply the same trimming methods to every alignment listed in the given
+ * file, one path per line. Alignments are trimmed concurrently, largest
+ * ones first, and the output files are written into the output directory.
+ * A summary line for each input file is printed at the end */
+bool batchTrimming(char *batchFile, char *outdir, trimmingOptions &options) {
+
+  ifstream list;
+  string nline;
+  struct stat info;
+  set<string> names;
+  const char *name;
+  batchJob job;
+  bool correct = true;
+  int i, numfiles = 0, capacity = 256;
+  char **tmp;
+
+  /* ***** ***** ***** ***** ***** ***** ***** ***** */
+  /* Read input files paths skipping blank lines */
+  list.open(batchFile, ifstream::in);
+  if(!list) {
+    cerr << endl << "ERROR: Check the file with the alignments to trim." << endl << endl;
+    return false;
+  }
 
-  delete[] filesToCompare;
-  delete[] compareVect;
+  job.files = new char*[capacity];
+  while(getline(list, nline)) {
+    if((!nline.empty()) && (nline[nline.size() - 1] == '\r'))
+      nline.erase(nline.size() - 1);
+    if(nline.empty())
+      continue;
+
+    if(numfiles == capacity) {
+      tmp = new char*[capacity * 2];
+      memcpy(tmp, job.files, capacity * sizeof(char *));
+      delete [] job.files;
+      job.files = tmp;
+      capacity *= 2;
+    }
+    job.files[numfiles] = new char[nline.size() + 1];
+    strcpy(job.files[numfiles++], nline.c_str());
+  }
+  list.close();
+  /* ***** ***** ***** ***** ***** ***** ***** ***** */
 
-  delete[] outfile;
-  delete[] outhtml;
+  /* ***** ***** ***** ***** ***** ***** ***** ***** */
+  /* Output files are named after input files, so they should be unique */
+  for(i = 0; (i < numfiles) && (correct); i++) {
+    name = strrchr(job.files[i], '/');
+    name = (name == NULL) ? job.files[i] : name + 1;
 
-  delete[] infile;
-  delete[] matrix;
-  /* -------------------------------------------------------------------- */
+    if(!names.insert(name).second) {
+      cerr << endl << "ERROR: There are several input files named \"" << name
+           << "\". Their output files would overwrite each other." << endl << endl;
+      correct = false;
+    }
+  }
 
-  return 0;
+  /* Create the output directory if it does not exist */
+  if((correct) && (stat(outdir, &info) == -1) && (mkdir(outdir, 0777) == -1)) {
+    cerr << endl << "ERROR: It's imposible to create the output directory \"" << outdir << "\"." << endl << endl;
+    correct = false;
+  }
+  else if((correct) && (stat(outdir, &info) == 0) && (!S_ISDIR(info.st_mode))) {
+    cerr << endl << "ERROR: \"" << outdir << "\" is not a directory." << endl << endl;
+    correct = false;
+  }
+  /* ***** ***** ***** ***** ***** ***** ***** ***** */
+
+  /* ***** ***** ***** ***** ***** ***** ***** ***** */
+  /* Largest alignments are scheduled first to balance the workload */
+  if(correct) {
+    job.options = &options;
+    job.outdir = outdir;
+    job.sizes = new long[numfiles];
+    job.order = new int[numfiles];
+    job.summary = new string[numfiles];
+    job.failed = new bool[numfiles];
+
+    for(i = 0; i <= RNADeg; i++)
+      job.matrices[i] = NULL;
+
+    for(i = 0; i < numfiles; i++) {
+      job.sizes[i] = (stat(job.files[i], &info) == 0) ? (long) info.st_size : 0;
+      job.order[i] = i;
+    }
+    sort(job.order, job.order + numfiles, largerBatchFile{job.sizes});
+
+    threadPool::runShared(numfiles, trimBatchFile, &job);
+
+    /* Summary table following the input list order */
+    cout << "#File\tStatus\tSequences\tColumns\tKeptSequences\tKeptColumns\tOutput" << endl;
+    for(i = 0; i < numfiles; i++) {
+      cout << job.summary[i] << endl;
+      if(job.failed[i])
+        correct = false;
+    }
+
+    for(i = 0; i <= RNADeg; i++)
+      delete job.matrices[i];
+
+    delete [] job.sizes;
+    delete [] job.order;
+    delete [] job.summary;
+    delete [] job.failed;
+  }
+  /* ***** ***** ***** ***** ***** ***** ***** ***** */
+
+  for(i = 0; i < numfiles; i++)
+    delete [] job.files[i];
+  delete [] job.files;
+
+  return correct;
 }
 
 void menu(void) {
@@ -1819,7 +2225,8 @@ void menu(void) {
   cout << "    -h                          " << "Print this information and show some examples." << endl;
   cout << "    --version                   " << "Print the trimAl version." << endl << endl;
 
-  cout << "    -in <inputfile>             " << "Input file in several formats (clustal, fasta, NBRF/PIR, nexus, phylip3.2, phylip)." << endl << endl;
+  cout << "    -in <inputfile>             " << "Input file in several formats (clustal, fasta, NBRF/PIR, nexus, phylip3.2, phylip, trimAl binary)." << endl;
+  cout << "                                " << "It may be compressed using gzip or zstd. Use - to read it from stdin." << endl << endl;
 
   cout << "    -compareset <inputfile>     " << "Input list of paths for the files containing the alignments to compare." << endl;
   cout << "    -forceselect <inputfile>    " << "Force selection of the given input file in the files comparison method." << endl << endl;
@@ -1834,7 +2241,20 @@ void menu(void) {
        << "                                Only available 'degenerated_nt_identity'" << endl << endl;
 
   cout << "    -out <outputfile>           " << "Output alignment in the same input format (default stdout). (default input format)" << endl;
-  cout << "    -htmlout <outputfile>       " << "Get a summary of trimal's work in an HTML file." << endl << endl;
+  cout << "                                " << "Use - to write it to stdout." << endl;
+  cout << "    -htmlout <outputfile>       " << "Get a summary of trimal's work in an HTML file." << endl;
+  cout << "                                " << "Output files named *.gz or *.zst are compressed." << endl << endl;
+
+  cout << "    -batch <inputfile>          " << "Input list of paths for alignments to be trimmed using the same options." << endl;
+  cout << "                                " << "Alignments are trimmed concurrently and a summary line is printed for each one." << endl;
+  cout << "    -outdir <directory>         " << "Output directory for the alignments trimmed in batch mode." << endl;
+  cout << "    -threads <n>                " << "Number of threads used for batch mode and for comparisons between all the" << endl;
+  cout << "                                " << "sequences (default: number of available processors)." << endl;
+  cout << "    -compactidentity            " << "Store identities between sequences as 16 bits values to reduce memory usage." << endl;
+  cout << "                                " << "Scores might differ slightly from the default ones." << endl;
+  cout << "    -approx_cons <k>            " << "Estimate similarity values from k pairs of residues per column. Columns whose" << endl;
+  cout << "                                " << "confidence interval contains a cut point are computed exactly. Results might" << endl;
+  cout << "                                " << "differ from the default ones." << endl << endl;
 
   cout << "    -keepheader                 " << "Keep original sequence header including non-alphanumeric characters." << endl;
   cout << "                                " << "Only available for input FASTA format files. (future versions will extend this feature)" << endl << endl;
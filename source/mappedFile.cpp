@@ -0,0 +1,101 @@
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+   ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+
+    trimAl v1.4: a tool for automated alignment trimming in large-scale
+                 phylogenetics analyses.
+
+    2009-2015 Capella-Gutierrez S. and Gabaldon, T.
+              [scapella, tgabaldon]@crg.es
+
+    This file is part of trimAl
+
+    trimAl is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, the last available version.
+
+    trimAl is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with trimAl. If not, see <http://www.gnu.org/licenses/>.
+
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "mappedFile.h"
+
+mappedFile::mappedFile(void) {
+  /* Initialize an empty mapping */
+  data = NULL;
+  size = 0;
+}
+
+mappedFile::~mappedFile(void) {
+  /* Release the mapping when the object goes out of scope */
+  close();
+}
+
+bool mappedFile::open(const char *fileName) {
+  /* Map the whole input file in memory. Any previous mapping is released */
+  bool mapped;
+  int fd;
+
+  close();
+
+  if((fd = ::open(fileName, O_RDONLY)) == -1)
+    return false;
+
+  /* The file descriptor is not longer needed once the mapping is ready */
+  mapped = open(fd);
+  ::close(fd);
+
+  return mapped;
+}
+
+bool mappedFile::open(int fd) {
+  /* Map the whole file behind the given descriptor */
+  struct stat info;
+  void *region;
+
+  close();
+
+  /* Check whether input file is a non-empty regular file */
+  if((fstat(fd, &info) == -1) || (!S_ISREG(info.st_mode)) || (info.st_size == 0))
+    return false;
+
+  region = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if(region == MAP_FAILED)
+    return false;
+
+  /* Input files are always read from the beginning to the end */
+  madvise(region, info.st_size, MADV_SEQUENTIAL);
+
+  data = (char *) region;
+  size = info.st_size;
+  return true;
+}
+
+void mappedFile::close(void) {
+  /* Unmap current file */
+  if(data != NULL)
+    munmap(data, size);
+
+  data = NULL;
+  size = 0;
+}
+
+const char *mappedFile::getData(void) {
+  return data;
+}
+
+long mappedFile::getSize(void) {
+  return size;
+}
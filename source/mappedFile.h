@@ -0,0 +1,69 @@
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+   ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+
+    trimAl v1.4: a tool for automated alignment trimming in large-scale
+                 phylogenetics analyses.
+
+    2009-2015 Capella-Gutierrez S. and Gabaldon, T.
+              [scapella, tgabaldon]@crg.es
+
+    This file is part of trimAl
+
+    trimAl is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, the last available version.
+
+    trimAl is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with trimAl. If not, see <http://www.gnu.org/licenses/>.
+
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <stdlib.h>
+
+using namespace std;
+
+/* ***************************************************************************************************************** */
+/*                                           Header Class File: mappedFile.                                          */
+/* ***************************************************************************************************************** */
+
+/* Read-only memory mapping of a whole input file. Parsers can walk the file
+ * contents directly without any intermediate buffering or per-line copies */
+
+class mappedFile {
+
+  char *data;
+  long size;
+
+ public:
+
+  /* Class constructor without parameters. */
+  mappedFile(void);
+
+  /* Class destroyer. */
+  ~mappedFile(void);
+
+  /* Map the given file in memory. It returns false if the file does not
+   * exist, it is empty or it is not possible to map it (e.g. pipes) */
+  bool open(const char *);
+
+  /* Map the file behind an already open descriptor, which is kept open */
+  bool open(int);
+
+  /* Release the current mapping, if any */
+  void close(void);
+
+  /* Mapped file contents and its size in bytes */
+  const char *getData(void);
+
+  long getSize(void);
+};
+#endif
@@ -0,0 +1,366 @@
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+   ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+
+    trimAl v1.4: a tool for automated alignment trimming in large-scale
+                 phylogenetics analyses.
+
+    2009-2015 Capella-Gutierrez S. and Gabaldon, T.
+              [scapella, tgabaldon]@crg.es
+
+    This file is part of trimAl
+
+    trimAl is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, the last available version.
+
+    trimAl is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with trimAl. If not, see <http://www.gnu.org/licenses/>.
+
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "outputFile.h"
+
+outputBuffer::outputBuffer(void) {
+  /* Initialize a buffer without any output file */
+  fd = -1;
+  compression = PLAINFILE;
+  failed = false;
+
+  blocks[0] = NULL;
+  blocks[1] = NULL;
+  current = 0;
+  pendingBlock = 0;
+  pendingSize = 0;
+  pending = false;
+  finished = false;
+
+  encoder = NULL;
+  packed = NULL;
+  packedSize = 0;
+}
+
+outputBuffer::~outputBuffer(void) {
+  /* Finish any open file */
+  close();
+}
+
+bool outputBuffer::open(const char *fileName, int format) {
+
+  close();
+
+  /* Check whether requested compression is available */
+#ifndef HAVE_ZLIB
+  if(format == GZIPFILE) {
+    cerr << endl << "ERROR: Output file \"" << fileName << "\" should be "
+      << "compressed using gzip but this build does not support it. Rebuild "
+      << "it with zlib installed." << endl;
+    return false;
+  }
+#endif
+#ifndef HAVE_ZSTD
+  if(format == ZSTDFILE) {
+    cerr << endl << "ERROR: Output file \"" << fileName << "\" should be "
+      << "compressed using zstd but this build does not support it. Rebuild "
+      << "it with libzstd installed." << endl;
+    return false;
+  }
+#endif
+
+  /* A "-" stands for the standard output. Anything already written to it
+   * using cout goes first */
+  if(!strcmp(fileName, "-")) {
+    cout.flush();
+    fd = dup(STDOUT_FILENO);
+  }
+  else
+    fd = ::open(fileName, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+
+  if(fd == -1)
+    return false;
+
+  /* Set-up compression stream. If it fails, the output file is closed
+   * before anything is written to it */
+  compression = format;
+#ifdef HAVE_ZLIB
+  if(compression == GZIPFILE) {
+    z_stream *stream = new z_stream;
+    memset(stream, 0, sizeof(z_stream));
+    /* Adding 16 to the window bits produces a gzip header and trailer */
+    if(deflateInit2(stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+      Z_DEFAULT_STRATEGY) != Z_OK) {
+      delete stream;
+      ::close(fd);
+      fd = -1;
+      compression = PLAINFILE;
+      return false;
+    }
+    encoder = stream;
+    packedSize = WRITEBLOCK;
+  }
+#endif
+#ifdef HAVE_ZSTD
+  if(compression == ZSTDFILE) {
+    ZSTD_CStream *stream = ZSTD_createCStream();
+    if((stream == NULL) || (ZSTD_isError(ZSTD_initCStream(stream, 3)))) {
+      ZSTD_freeCStream(stream);
+      ::close(fd);
+      fd = -1;
+      compression = PLAINFILE;
+      return false;
+    }
+    encoder = stream;
+    packedSize = ZSTD_CStreamOutSize();
+  }
+#endif
+  if(compression != PLAINFILE)
+    packed = new char[packedSize];
+
+  blocks[0] = new char[WRITEBLOCK];
+  blocks[1] = new char[WRITEBLOCK];
+  current = 0;
+  setp(blocks[current], blocks[current] + WRITEBLOCK);
+
+  failed = false;
+  pending = false;
+  finished = false;
+  worker = thread(&outputBuffer::writeBlocks, this);
+
+  return true;
+}
+
+bool outputBuffer::close(void) {
+  /* Write last block, wait for the background thread and release memory */
+  bool correct;
+
+  if(fd == -1)
+    return true;
+
+  handBlock();
+  {
+    lock_guard<mutex> guard(lock);
+    finished = true;
+  }
+  ready.notify_all();
+  worker.join();
+
+  correct = !failed;
+  if(::close(fd) == -1)
+    correct = false;
+  fd = -1;
+
+#ifdef HAVE_ZLIB
+  if(compression == GZIPFILE) {
+    deflateEnd((z_stream *) encoder);
+    delete (z_stream *) encoder;
+  }
+#endif
+#ifdef HAVE_ZSTD
+  if(compression == ZSTDFILE)
+    ZSTD_freeCStream((ZSTD_CStream *) encoder);
+#endif
+  encoder = NULL;
+  compression = PLAINFILE;
+
+  delete [] packed;
+  packed = NULL;
+  packedSize = 0;
+
+  delete [] blocks[0];
+  delete [] blocks[1];
+  blocks[0] = NULL;
+  blocks[1] = NULL;
+  setp(NULL, NULL);
+
+  return correct;
+}
+
+bool outputBuffer::handBlock(void) {
+  /* Wait until the background thread is done with the previous block */
+  unique_lock<mutex> guard(lock);
+  ready.wait(guard, [this] { return !pending; });
+
+  if(failed)
+    return false;
+
+  pendingBlock = current;
+  pendingSize = pptr() - pbase();
+  pending = true;
+  guard.unlock();
+  ready.notify_all();
+
+  /* Keep on filling the other block */
+  current = 1 - current;
+  setp(blocks[current], blocks[current] + WRITEBLOCK);
+
+  return true;
+}
+
+void outputBuffer::writeBlocks(void) {
+  /* Write every given block till the output file is closed */
+  unique_lock<mutex> guard(lock);
+  bool correct;
+
+  while(true) {
+    ready.wait(guard, [this] { return pending || finished; });
+
+    if(pending) {
+      guard.unlock();
+      correct = writeBlock(blocks[pendingBlock], pendingSize, false);
+      guard.lock();
+
+      failed = failed || !correct;
+      pending = false;
+      ready.notify_all();
+    }
+    else
+      break;
+  }
+  guard.unlock();
+
+  /* Close the compressed stream */
+  correct = writeBlock(NULL, 0, true);
+
+  guard.lock();
+  failed = failed || !correct;
+}
+
+bool outputBuffer::writeBlock(const char *data, long size, bool last) {
+
+#ifdef HAVE_ZLIB
+  if(compression == GZIPFILE) {
+    z_stream *stream = (z_stream *) encoder;
+
+    stream -> next_in = (Bytef *) data;
+    stream -> avail_in = (uInt) size;
+    do {
+      stream -> next_out = (Bytef *) packed;
+      stream -> avail_out = (uInt) packedSize;
+      if(deflate(stream, last ? Z_FINISH : Z_NO_FLUSH) == Z_STREAM_ERROR)
+        return false;
+      if(!writeAll(packed, packedSize - stream -> avail_out))
+        return false;
+    } while(stream -> avail_out == 0);
+    return true;
+  }
+#endif
+
+#ifdef HAVE_ZSTD
+  if(compression == ZSTDFILE) {
+    ZSTD_CStream *stream = (ZSTD_CStream *) encoder;
+    ZSTD_inBuffer input = {data, (size_t) size, 0};
+    ZSTD_outBuffer output;
+    size_t state;
+
+    do {
+      output.dst = packed;
+      output.size = packedSize;
+      output.pos = 0;
+      if(last)
+        state = ZSTD_endStream(stream, &output);
+      else
+        state = ZSTD_compressStream(stream, &output, &input);
+      if(ZSTD_isError(state))
+        return false;
+      if(!writeAll(packed, output.pos))
+        return false;
+    } while((last && (state != 0)) || (input.pos < input.size));
+    return true;
+  }
+#endif
+
+  return writeAll(data, size);
+}
+
+bool outputBuffer::writeAll(const char *data, long size) {
+  /* Write the whole data, even if the system writes just a part of it */
+  long bytes;
+
+  while(size > 0) {
+    bytes = write(fd, data, size);
+    if(bytes == -1) {
+      if(errno == EINTR)
+        continue;
+      return false;
+    }
+    data += bytes;
+    size -= bytes;
+  }
+  return true;
+}
+
+int outputBuffer::overflow(int c) {
+  /* Current block is full: give it to the background thread */
+  if((fd == -1) || (!handBlock()))
+    return traits_type::eof();
+
+  if(c != traits_type::eof()) {
+    *pptr() = (char) c;
+    pbump(1);
+  }
+  return traits_type::not_eof(c);
+}
+
+int outputBuffer::sync(void) {
+  /* Blocks are written once they are full or when the file is closed. It
+   * avoids giving tiny blocks to the background thread for each "endl" */
+  return 0;
+}
+
+outputFile::outputFile(void) : ostream(NULL) {
+  rdbuf(&buffer);
+}
+
+outputFile::~outputFile(void) {
+  buffer.close();
+}
+
+bool outputFile::open(const char *fileName) {
+  /* Create output file and reset stream state */
+  clear();
+  if(!buffer.open(fileName, detectCompression(fileName))) {
+    setstate(ios::failbit);
+    return false;
+  }
+  return true;
+}
+
+bool outputFile::close(void) {
+  /* Finish the output file */
+  bool correct = buffer.close();
+
+  return correct && !bad();
+}
+
+int outputFile::detectCompression(const char *fileName) {
+  /* Output files named "*.gz" are compressed using gzip and "*.zst" ones
+   * using zstd */
+  size_t length = strlen(fileName);
+
+  if((length > 3) && (!strcmp(fileName + length - 3, ".gz")))
+    return GZIPFILE;
+  if((length > 4) && (!strcmp(fileName + length - 4, ".zst")))
+    return ZSTDFILE;
+
+  return PLAINFILE;
+}
@@ -0,0 +1,128 @@
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+   ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+
+    trimAl v1.4: a tool for automated alignment trimming in large-scale
+                 phylogenetics analyses.
+
+    2009-2015 Capella-Gutierrez S. and Gabaldon, T.
+              [scapella, tgabaldon]@crg.es
+
+    This file is part of trimAl
+
+    trimAl is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, the last available version.
+
+    trimAl is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with trimAl. If not, see <http://www.gnu.org/licenses/>.
+
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+
+#ifndef OUTPUTFILE_H
+#define OUTPUTFILE_H
+
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "defines.h"
+
+using namespace std;
+
+/* ***************************************************************************************************************** */
+/*                                           Header Class File: outputFile.                                          */
+/* ***************************************************************************************************************** */
+
+/* Output file stream. Data is collected in large blocks which are handed to
+ * a background thread that compresses them, when the file name ends with
+ * ".gz" or ".zst", and writes them to the disk. Meanwhile, the caller keeps
+ * on filling the other block, so it never waits for the compression */
+
+class outputBuffer : public streambuf {
+
+  int fd;
+  int compression;
+  bool failed;
+
+  /* Block being filled and block waiting to be written */
+  char *blocks[2];
+  int current;
+  int pendingBlock;
+  long pendingSize;
+  bool pending;
+  bool finished;
+
+  /* Compression stream and area for compressed data */
+  void *encoder;
+  char *packed;
+  long packedSize;
+
+  thread worker;
+  mutex lock;
+  condition_variable ready;
+
+  /* Background thread main loop */
+  void writeBlocks(void);
+
+  /* Compress, if needed, and write the given data. The last call for a
+   * compressed stream has to close it */
+  bool writeBlock(const char *, long, bool);
+
+  /* Write all given bytes to the output file */
+  bool writeAll(const char *, long);
+
+  /* Give current block to the background thread and start a new one */
+  bool handBlock(void);
+
+ protected:
+
+  int overflow(int);
+  int sync(void);
+
+ public:
+
+  /* Class constructor without parameters. */
+  outputBuffer(void);
+
+  /* Class destroyer. */
+  ~outputBuffer(void);
+
+  /* Create the given file, with the given compression, and start the
+   * background thread */
+  bool open(const char *, int);
+
+  /* Write remaining data and close the output file. It returns false if any
+   * error has happened while writing */
+  bool close(void);
+};
+
+class outputFile : public ostream {
+
+  outputBuffer buffer;
+
+ public:
+
+  /* Class constructor without parameters. */
+  outputFile(void);
+
+  /* Class destroyer. */
+  ~outputFile(void);
+
+  /* Create the given file, "-" for the standard output. Output compression
+   * is chosen from its name */
+  bool open(const char *);
+
+  /* Finish the output file. It returns false on any writing error */
+  bool close(void);
+
+  /* Guess output compression from the file name extension */
+  static int detectCompression(const char *);
+};
+#endif
@@ -43,7 +43,8 @@ int main(int argc, char *argv[]) {
   int i, outformat = -1;
   char *infile = NULL, *outfile = NULL;
   bool errors = false, reverse = false, shortNames = false, format = false, \
-    type = false, info = false;
+    type = false, info = false, binaryIdentity = false, upper = false, \
+    lower = false;
 
   /* If there is no parameters: Inform about readAl options and finish */
   if(argc == 1) {
@@ -107,6 +108,13 @@ int main(int argc, char *argv[]) {
     else if(!strcmp(argv[i], "-reverse") && (!reverse))
       reverse = true;
 
+    /* Write residues in upper or lower case: -upper, -lower */
+    else if(!strcmp(argv[i], "-upper") && (!upper) && (!lower))
+      upper = true;
+
+    else if(!strcmp(argv[i], "-lower") && (!upper) && (!lower))
+      lower = true;
+
     /* For all output format options is checked if more
      * than one output format has been required */
 
@@ -177,6 +185,17 @@ int main(int argc, char *argv[]) {
     else if(!strcmp(argv[i], "-html") && (outformat == -1))
       outformat = 100;
 
+    /* Set output alignment format to trimAl binary format: -binary */
+    else if(!strcmp(argv[i], "-binary") && (outformat == -1))
+      outformat = 30;
+
+    /* Set output alignment format to trimAl binary format and ask for
+     * storing sequences identities as well: -binary_ident */
+    else if(!strcmp(argv[i], "-binary_ident") && (outformat == -1)) {
+      outformat = 30;
+      binaryIdentity = true;
+    }
+
     /* Get unaligned sequences from input file: -onlyseqs */
     else if(!strcmp(argv[i], "-onlyseqs") && (outformat == -1))
       outformat = 99;
@@ -203,15 +222,15 @@ int main(int argc, char *argv[]) {
   }
 
   /* It is mandatory to choose an option for processing input alignment */
-  if((outformat == -1) && (!reverse) && (!format) && (!type) && (!info)
-    && (!errors)) {
+  if((outformat == -1) && (!reverse) && (!upper) && (!lower) && (!format)
+    && (!type) && (!info) && (!errors)) {
     cerr << endl << "ERROR: An option has to be chosen." << endl << endl;
     errors = true;
   }
 
   /* Only one option can be selected when an output file is not defined */
-  if((outfile == NULL) && ((outformat != -1) || reverse) && (format || type \
-    || info) && (!errors)) {
+  if((outfile == NULL) && ((outformat != -1) || reverse || upper || lower) \
+    && (format || type || info) && (!errors)) {
     cerr << endl << "ERROR: Only one option can be selected: either an output "
       << "format or get information about input file when an output file is "
       << "not defined" << endl << endl;
@@ -220,8 +239,8 @@ int main(int argc, char *argv[]) {
 
   /* Does not make any sense to define any output file when
    * only information about input alignment is requested */
-  if(((outfile != NULL) && outformat == -1 && !reverse) && (format || type \
-    || info) && (!errors)) {
+  if(((outfile != NULL) && outformat == -1 && !reverse && !upper && !lower) \
+    && (format || type || info) && (!errors)) {
     cerr << endl << "ERROR: An output file should not be provided when only "
       << "information about input alignment is requested" << endl << endl;
     errors = true;
@@ -283,13 +302,27 @@ int main(int argc, char *argv[]) {
         inAlig.printAlignmentInfo(cout);
     }
 
-    if((outfile != NULL) || (outformat != -1) || reverse || shortNames) {
+    if((outfile != NULL) || (outformat != -1) || reverse || upper || lower \
+      || shortNames) {
       /* Set output format */
       if(outformat != -1 || shortNames)
         inAlig.setOutputFormat(outformat, shortNames);
       /* Ask for getting the reverse of input file */
       if(reverse)
         inAlig.setReverse();
+      /* Change residues case when they are written */
+      if(upper || lower)
+        inAlig.setCase(upper);
+
+      /* Compute sequences identities to store them in the binary output */
+      if(binaryIdentity) {
+        if(!inAlig.isFileAligned()) {
+          cerr << endl << "ERROR: Sequences identities can only be stored for "
+            << "aligned sequences." << endl << endl;
+          return -1;
+        }
+        inAlig.calculateSeqIdentity();
+      }
 
       /* If a outfile has been provided, try to generate output file */
       if(outfile != NULL) {
@@ -334,8 +367,12 @@ void menu(void) {
     << "\t-h                   " << "Show this information." << endl
     << "\t--version            " << "Show readAl version." << endl << endl
 
-    << "\t-in <inputfile>      " << "Input file in several formats." << endl
-    << "\t-out <outputfile>    " << "Output file name (default STDOUT)." << endl
+    << "\t-in <inputfile>      " << "Input file in several formats. It may be" << endl
+    << "\t                     " << "compressed using gzip or zstd. Use - to" << endl
+    << "\t                     " << "read it from STDIN." << endl
+    << "\t-out <outputfile>    " << "Output file name (default STDOUT). Files" << endl
+    << "\t                     " << "named *.gz or *.zst are compressed. Use -" << endl
+    << "\t                     " << "to write it to STDOUT." << endl
     << endl
 
     << "\t-format              " << "Print information about input file format "
@@ -358,6 +395,10 @@ void menu(void) {
     << "\t-reverse             " << "Output the reverse of sequences in "
     << "input file." << endl << endl
 
+    << "\t-upper               " << "Output residues in upper case." << endl
+    << "\t-lower               " << "Output residues in lower case." << endl
+    << endl
+
     << "\t-nbrf                " << "Output file in NBRF/PIR format" << endl
     << "\t-mega                " << "Output file in MEGA format" << endl
 
@@ -379,5 +420,12 @@ void menu(void) {
     << "with PAML. Sequences name up to 10 characters." << endl
     << "\t-phylip3.2           " << "Output file in PHYLIP3.2 format" << endl
     << "\t-phylip3.2_m10       " << "Output file in PHYLIP3.2 format. Sequences"
-    << " name up to 10 characters." << endl << endl;
+    << " name up to 10 characters." << endl << endl
+
+    << "\t-binary              " << "Output file in trimAl binary format. It "
+    << "keeps datatype and gaps per column" << endl
+    << "\t                     " << "to load it faster in trimAl and statAl."
+    << endl
+    << "\t-binary_ident        " << "Output file in trimAl binary format "
+    << "including sequences identities." << endl << endl;
 }
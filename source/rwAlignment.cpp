@@ -30,9 +30,11 @@
 #include "alignment.h"
 #include "defines.h"
 #include "utils.h"
+#include "threadPool.h"
 
 extern int errno;
 #include <errno.h>
+#include <stdint.h>
 #include <ctype.h>
 #include <string>
 
@@ -139,22 +141,17 @@ void alignment::getSequences(ostream &file) {
   delete [] tmpMatrix;
 }
 
-int alignment::formatInputAlignment(char *alignmentFile) {
-  /* Guess input alignment format */
+int alignment::formatInputAlignment(lineReader &file) {
+  /* Guess input alignment format. Lines are only peeked at, so the parser
+   * reads the same buffered data later on without opening the file again */
 
   char c, *firstWord = NULL, *line = NULL;
   int format = 0, blocks = 0;
-  ifstream file;
   string nline;
 
-  /* Check the file and its content */
-  file.open(alignmentFile, ifstream::in);
-  if(!utils::checkFile(file))
-    return false;
-
   /* Read first valid line in a safer way */
   do {
-    line = utils::readLine(file);
+    line = file.peekLine();
   } while ((line == NULL) && (!file.eof()));
 
   /* If the file end is reached without a valid line, warn about it */
@@ -180,6 +177,10 @@ int alignment::formatInputAlignment(char *alignmentFile) {
   else if((!strcmp(firstWord, "#NEXUS")) || (!strcmp(firstWord, "#nexus")))
     format = 17;
 
+  /* trimAl binary Format */
+  else if(!strcmp(firstWord, "#TRIMALBIN"))
+    format = 30;
+
   /* Mega Format */
   else if((!strcmp(firstWord, "#MEGA")) || (!strcmp(firstWord, "#mega"))) {
 
@@ -188,13 +189,13 @@ int alignment::formatInputAlignment(char *alignmentFile) {
      * the input file. */
     blocks = 0;
     do {
-      file.read(&c, 1);
+      file.readChar(c);
     } while((c != '#') && (!file.eof()));
 
     do {
       while((c != '\n') && (!file.eof()))
-        file.read(&c, 1);
-      file.read(&c, 1);
+        file.readChar(c);
+      file.readChar(c);
       if(c == '#')
         blocks++;
     } while((c != '\n') && (!file.eof()));
@@ -225,9 +226,7 @@ int alignment::formatInputAlignment(char *alignmentFile) {
 
       /* Read line in a safer way */
       do {
-        if (line != NULL)
-          delete [] line;
-        line = utils::readLine(file);
+        line = file.peekLine();
       } while ((line == NULL) && (!file.eof()));
 
       /* If the file end is reached without a valid line, warn about it */
@@ -242,9 +241,7 @@ int alignment::formatInputAlignment(char *alignmentFile) {
 
       /* Read line in a safer way */
       do {
-        if (line != NULL)
-          delete [] line;
-        line = utils::readLine(file);
+        line = file.peekLine();
       } while ((line == NULL) && (!file.eof()));
 
       firstWord = strtok(line, DELIMITERS);
@@ -262,27 +259,19 @@ int alignment::formatInputAlignment(char *alignmentFile) {
     }
   }
 
-  /* Close the input file and delete dinamic memory */
-  file.close();
-  if (line != NULL)
-    delete [] line;
+  /* Move back to the file beginning for the parser */
+  file.rewind();
 
   /* Return the input alignment format */
   return format;
 }
 
-bool alignment::loadPhylipAlignment(char *alignmentFile) {
+bool alignment::loadPhylipAlignment(char *alignmentFile, lineReader &file) {
   /* PHYLIP/PHYLIP 4 (Sequential) file format parser */
 
   char *str, *line = NULL;
-  ifstream file;
   int i;
 
-  /* Check the file and its content */
-  file.open(alignmentFile, ifstream::in);
-  if(!utils::checkFile(file))
-    return false;
-
   /* Store some data about filename for possible uses in other formats */
   filename.append("!Title ");
   filename.append(alignmentFile);
@@ -290,7 +279,7 @@ bool alignment::loadPhylipAlignment(char *alignmentFile) {
 
   /* Read first valid line in a safer way */
   do {
-    line = utils::readLine(file);
+    line = file.readLine();
   } while ((line == NULL) && (!file.eof()));
 
   /* If the file end is reached without a valid line, warn about it */
@@ -321,10 +310,7 @@ bool alignment::loadPhylipAlignment(char *alignmentFile) {
   i = 0;
   while((i < sequenNumber) && (!file.eof())){
 
-    /* Read lines in a safer way. Destroy previous stored information */
-    if (line != NULL)
-      delete [] line;
-    line = utils::readLine(file);
+    line = file.readLine();
 
     /* It the input line/s are blank lines, skip the loop iteration  */
     if(line == NULL)
@@ -349,11 +335,7 @@ bool alignment::loadPhylipAlignment(char *alignmentFile) {
     /* Try to get for each sequences its corresponding residues */
     i = 0;
     while((i < sequenNumber) && (!file.eof())) {
-      /* Read lines in a safer way. Destroy previous stored information */
-      if (line != NULL)
-        delete [] line;
-
-      line = utils::readLine(file);
+      line = file.readLine();
       /* It the input line/s are blank lines, skip the loop iteration  */
       if(line == NULL)
         continue;
@@ -369,26 +351,18 @@ bool alignment::loadPhylipAlignment(char *alignmentFile) {
     }
   }
 
-  /* Close the input file and delete dinamic memory */
+  /* Close the input file */
   file.close();
-  if (line != NULL)
-    delete [] line;
 
   /* Check the matrix's content */
   return fillMatrices(true);
 }
 
-bool alignment::loadPhylip3_2Alignment(char *alignmentFile) {
+bool alignment::loadPhylip3_2Alignment(char *alignmentFile, lineReader &file) {
   /* PHYLIP 3.2 (Interleaved) file format parser */
 
   int i, blocksFirstLine, firstLine = true;
   char *str, *line = NULL;
-  ifstream file;
-
-  /* Check the file and its content */
-  file.open(alignmentFile, ifstream::in);
-  if(!utils::checkFile(file))
-    return false;
 
   /* Store the file name for futher format conversion*/
   filename.append("!Title ");
@@ -397,7 +371,7 @@ bool alignment::loadPhylip3_2Alignment(char *alignmentFile) {
 
   /* Read first valid line in a safer way */
   do {
-    line = utils::readLine(file);
+    line = file.readLine();
   } while ((line == NULL) && (!file.eof()));
 
   /* If the file end is reached without a valid line, warn about it */
@@ -430,11 +404,7 @@ bool alignment::loadPhylip3_2Alignment(char *alignmentFile) {
   blocksFirstLine = 0;
 
   do {
-    /* Read lines in a safer way. Destroy previous stored information */
-    if (line != NULL)
-      delete [] line;
-
-    line = utils::readLine(file);
+    line = file.readLine();
     /* If there is nothing in the input line, skip the loop instructions */
     if(line == NULL)
       continue;
@@ -484,26 +454,18 @@ bool alignment::loadPhylip3_2Alignment(char *alignmentFile) {
     }
   } while(!file.eof());
 
-  /* Close the input file and delete dinamic memory */
+  /* Close the input file */
   file.close();
-  if (line != NULL)
-    delete [] line;
 
   /* Check the matrix's content */
   return fillMatrices(true);
 }
 
-bool alignment::loadClustalAlignment(char *alignmentFile) {
+bool alignment::loadClustalAlignment(char *alignmentFile, lineReader &file) {
   /* CLUSTAL file format parser */
 
   int i, seqLength, pos, firstBlock;
   char *str, *line = NULL;
-  ifstream file;
-
-  /* Check input file and its content */
-  file.open(alignmentFile, ifstream::in);
-  if(!utils::checkFile(file))
-    return false;
 
   /* Store some details about input file to be used in posterior format
    * conversions */
@@ -513,7 +475,7 @@ bool alignment::loadClustalAlignment(char *alignmentFile) {
 
   /* The first valid line corresponding to CLUSTAL label is ignored */
   do {
-    line = utils::readLine(file);
+    line = file.scanLine();
   } while ((line == NULL) && (!file.eof()));
 
   /* If the file end is reached without a valid line, warn about it */
@@ -523,19 +485,15 @@ bool alignment::loadClustalAlignment(char *alignmentFile) {
   /* Ignore blank lines before first sequence block starts */
   while(!file.eof()) {
 
-    /* Deallocate previously used dynamic memory */
-    if (line != NULL)
-      delete [] line;
-
     /* Read lines in safe way */
-    line = utils::readLine(file);
+    line = file.scanLine();
 
     if (line != NULL)
       break;
   }
 
   /* The program in only interested in the first blocks of sequences since
-   * it wants to know how many sequences are in the input file */
+   * it wants to know how many sequences are in the input file. */
   sequenNumber = 0;
   while(!file.eof()) {
 
@@ -558,24 +516,19 @@ bool alignment::loadClustalAlignment(char *alignmentFile) {
       break;
     sequenNumber++;
 
-    /* Deallocate previously used dynamic memory */
-    if (line != NULL)
-      delete [] line;
-
     /* Read lines in safe way */
-    line = utils::readLine(file);
+    line = file.scanLine();
   }
 
   /* Finish to preprocess the input file. */
-  file.clear();
-  file.seekg(0);
+  file.rewind();
 
   /* Allocate memory for the input alignmet */
   seqsName  = new string[sequenNumber];
   sequences = new string[sequenNumber];
 
   /* Read the title line and store it */
-  line = utils::readLine(file);
+  line = file.readLine();
   if (line == NULL)
     return false;
   aligInfo.append(line, strlen(line));
@@ -583,12 +536,8 @@ bool alignment::loadClustalAlignment(char *alignmentFile) {
   /* Ignore blank lines before first sequence block starts */
   while(!file.eof()) {
 
-    /* Deallocate previously used dynamic memory */
-    if (line != NULL)
-      delete [] line;
-
     /* Read lines in safe way */
-    line = utils::readLine(file);
+    line = file.readLine();
 
     if (line != NULL)
       break;
@@ -609,7 +558,7 @@ bool alignment::loadClustalAlignment(char *alignmentFile) {
       if (i == 0)
         firstBlock = false;
       /* Read current line and analyze it*/
-      line = utils::readLine(file);
+      line = file.readLine();
       continue;
     }
 
@@ -624,12 +573,8 @@ bool alignment::loadClustalAlignment(char *alignmentFile) {
     if (pos == seqLength) {
       firstBlock = false;
 
-      /* Deallocate dinamic memory if it has been used before */
-      if (line != NULL)
-        delete [] line;
-
       /* Read current line and analyze it*/
-      line = utils::readLine(file);
+      line = file.readLine();
 
       continue;
     }
@@ -649,84 +594,57 @@ bool alignment::loadClustalAlignment(char *alignmentFile) {
       i = (i + 1) % sequenNumber;
     }
 
-    /* Deallocate dinamic memory if it has been used before */
-    if (line != NULL)
-      delete [] line;
-
     /* Read current line and analyze it*/
-    line = utils::readLine(file);
+    line = file.readLine();
   }
 
   /* Close the input file */
   file.close();
 
-  /* Deallocate dinamic memory */
-  if (line != NULL)
-    delete [] line;
-
   /* Check the matrix's content */
   return fillMatrices(true);
 }
 
-bool alignment::loadFastaAlignment(char *alignmentFile) {
-  /* FASTA file format parser */
+bool alignment::loadFastaAlignment(char *alignmentFile, lineReader &file) {
+  /* FASTA file format parser. Input file is read just once: memory for the
+   * sequences is enlarged every time it is full */
 
   char *str, *line = NULL;
-  ifstream file;
-  int i;
-
-  /* Check the file and its content */
-  file.open(alignmentFile, ifstream::in);
-  if(!utils::checkFile(file))
-    return false;
+  string *tmpNames, *tmpSeqs, *tmpInfo;
+  int i, j, allocated = 0;
 
   /* Store input file name for posterior uses in other formats */
   filename.append("!Title ");
   filename.append(alignmentFile);
   filename.append(";");
 
-  /* Compute how many sequences are in the input alignment */
-  sequenNumber = 0;
-  while(!file.eof()) {
-
-    /* Deallocate previously used dinamic memory */
-    if (line != NULL)
-      delete [] line;
+  for(i = -1; !file.eof(); ) {
 
     /* Read lines in a safe way */
-    line = utils::readLine(file);
+    line = file.readLine();
     if (line == NULL)
       continue;
 
-    /* It the line starts by ">" means that a new sequence has been found */
-    str = strtok(line, DELIMITERS);
-    if (str == NULL)
-      continue;
-
-    /* If a sequence name flag is detected, increase sequences counter */
-    if(str[0] == '>')
-      sequenNumber++;
-  }
-
-  /* Finish to preprocess the input file. */
-  file.clear();
-  file.seekg(0);
-
-  /* Allocate memory for the input alignmet */
-  seqsName  = new string[sequenNumber];
-  sequences = new string[sequenNumber];
-  seqsInfo  = new string[sequenNumber];
-
-  for(i = -1; (i < sequenNumber) && (!file.eof()); ) {
-
-    /* Deallocate previously used dinamic memory */
-    if (line != NULL)
-      delete [] line;
-
-    /* Read lines in a safe way */
-    line = utils::readLine(file);
-    if (line == NULL)
-      continue;
+    /* Make room for a new sequence when all allocated ones are in use */
+    if(i + 1 == allocated) {
+      allocated = (allocated == 0) ? 64 : allocated * 2;
+      tmpNames = new string[allocated];
+      tmpSeqs  = new string[allocated];
+      tmpInfo  = new string[allocated];
+      for(j = 0; j <= i; j++) {
+        tmpNames[j].swap(seqsName[j]);
+        tmpSeqs[j].swap(sequences[j]);
+        tmpInfo[j].swap(seqsInfo[j]);
+      }
+      if(i != -1) {
+        delete [] seqsName;
+        delete [] sequences;
+        delete [] seqsInfo;
+      }
+      seqsName  = tmpNames;
+      sequences = tmpSeqs;
+      seqsInfo  = tmpInfo;
+    }
 
     /* Store original header fom input sequences including non-standard
      * characters */
@@ -749,35 +667,465 @@ bool alignment::loadFastaAlignment(char *alignmentFile) {
       continue;
     }
 
+    /* Lines before the first header do not belong to any sequence */
+    if(i == -1)
+      continue;
+
     /* Sequence */
     while(str != NULL) {
       sequences[i].append(str, strlen(str));
       str = strtok(NULL, DELIMITERS);
     }
   }
+  sequenNumber = i + 1;
 
   /* Close the input file */
   file.close();
 
-  /* Deallocate previously used dinamic memory */
-  if (line != NULL)
-    delete [] line;
+  /* Check the matrix's content */
+  return fillMatrices(false);
+}
+
+static inline bool isFastaDelimiter(char c) {
+  /* Characters used by the FASTA parser to split lines (OTHDELIMITERS) */
+  return (c == ' ') || (c == '\t') || (c == '\n') || (c == ',') || (c == ':');
+}
+
+static inline bool isBlankDelimiter(char c) {
+  /* Characters used to split residues blocks in a line (DELIMITERS) */
+  return (c == ' ') || (c == '\t') || (c == '\n');
+}
+
+static const char *cleanMappedLine(const char *begin, const char *end,
+  string &buffer, int &length) {
+  /* Get the same line content that utils::readLine would return for the
+   * input line between begin and end but without copying it unless it is
+   * really needed */
+  const char *nul;
+
+  /* Carriage returns are removed wherever they appear in the line */
+  if(memchr(begin, '\r', end - begin) != NULL) {
+    buffer.clear();
+    for( ; begin < end; begin++)
+      if(*begin != '\r')
+        buffer += *begin;
+    begin = buffer.data();
+    end = begin + buffer.size();
+  }
+
+  /* Lines are cut at the first null character */
+  if((nul = (const char *) memchr(begin, '\0', end - begin)) != NULL)
+    end = nul;
+
+  /* Remove blank spaces and then tabs from the line beginning */
+  while((begin < end) && (*begin == ' '))
+    begin++;
+  while((begin < end) && (*begin == '\t'))
+    begin++;
+
+  length = end - begin;
+  return begin;
+}
+
+static int parallelTasks(long size) {
+  /* Number of tasks used to parse an input of the given size in parallel.
+   * Small inputs are parsed by the calling thread alone */
+  long tasks;
+  int threads;
+
+  if(size < 2 * PARALLELBLOCK)
+    return 1;
+
+  threads = threadPool::getShared() -> getThreads();
+  tasks = size / PARALLELBLOCK;
+  if(tasks > 4 * threads)
+    tasks = 4 * threads;
+  return (int) tasks;
+}
+
+static void appendOffset(long *&offsets, int &count, int &capacity,
+  long offset) {
+  /* Append an offset to an array which grows as needed */
+  long *tmp;
+
+  if(count == capacity) {
+    tmp = new long[capacity * 2];
+    memcpy(tmp, offsets, capacity * sizeof(long));
+    delete [] offsets;
+    offsets = tmp;
+    capacity *= 2;
+  }
+  offsets[count++] = offset;
+}
+
+static long *joinOffsets(long **offsets, int *counts, int tasks, int &total) {
+  /* Join, in order, the offsets found by each task */
+  long *joined;
+  int i;
+
+  for(i = 0, total = 0; i < tasks; i++)
+    total += counts[i];
+
+  joined = new long[total + 1];
+  for(i = 0, total = 0; i < tasks; i++) {
+    memcpy(&joined[total], offsets[i], counts[i] * sizeof(long));
+    total += counts[i];
+    delete [] offsets[i];
+  }
+  return joined;
+}
+
+struct mappedParse {
+  /* Data shared by the tasks parsing a memory-mapped file */
+  const char *data, *begin, *end;
+  int tasks;
+  long **offsets;
+  int *counts;
+  int *first;
+  int count, number;
+  string *names, *residues, *headers;
+};
+
+static void findFastaHeaders(int task, void *argument) {
+  /* Look for sequence headers in a chunk of the input file. A '>' starts
+   * a new sequence if there are only delimiters between the line beginning
+   * and itself. Headers are assigned to the chunk containing its '>' */
+  mappedParse *parse = (mappedParse *) argument;
+  const char *data = parse -> data, *ptr, *head, *end;
+  int capacity = 256;
+
+  ptr = data + (parse -> end - data) * task / parse -> tasks;
+  end = data + (parse -> end - data) * (task + 1) / parse -> tasks;
+
+  parse -> offsets[task] = new long[capacity];
+  parse -> counts[task] = 0;
+
+  for( ; (ptr < end) &&
+    ((ptr = (const char *) memchr(ptr, '>', end - ptr)) != NULL); ptr++) {
+
+    for(head = ptr; (head > data) && ((head[-1] == '\r') ||
+      ((head[-1] != '\n') && (isFastaDelimiter(head[-1])))); head--) ;
+
+    if((head != data) && (head[-1] != '\n'))
+      continue;
+
+    /* Store where the header line starts */
+    appendOffset(parse -> offsets[task], parse -> counts[task], capacity,
+      head - data);
+
+    /* Skip the rest of the header line */
+    if((ptr = (const char *) memchr(ptr, '\n', parse -> end - ptr)) == NULL)
+      break;
+  }
+}
+
+static void parseFastaRecords(int task, void *argument) {
+  /* Parse the sequences assigned to a task. Lines are split in the same way
+   * that the stream-based parser does to get the same result */
+  mappedParse *parse = (mappedParse *) argument;
+  const char *data = parse -> data, *ptr, *head, *next, *line, *lineEnd;
+  const char *token;
+  long *starts = parse -> offsets[0];
+  int i, j, length;
+  string buffer;
+
+  for(i = parse -> first[task]; i < parse -> first[task + 1]; i++) {
+    ptr = data + starts[i];
+    next = (i + 1 < parse -> number) ? data + starts[i + 1] : parse -> end;
+
+    /* Header line: store original header including non-standard characters
+     * and the sequence name */
+    if((lineEnd = (const char *) memchr(ptr, '\n', next - ptr)) == NULL)
+      lineEnd = next;
+    line = cleanMappedLine(ptr, lineEnd, buffer, length);
+
+    if(line[0] == '>')
+      parse -> headers[i].append(&line[1], length - 1);
+
+    for(j = 0; isFastaDelimiter(line[j]); j++) ;
+    for(token = &line[j + 1]; (token < line + length) &&
+      (!isFastaDelimiter(*token)); token++) ;
+
+    /* Sequence name starts after the '>'. If it is alone, the name is the
+     * rest of the line after the following delimiter */
+    if(token - &line[j] > 1)
+      parse -> names[i].append(&line[j + 1], token - &line[j] - 1);
+    else if(token + 1 < line + length)
+      parse -> names[i].append(token + 1, line + length - token - 1);
+
+    /* Sequence: residues blocks from the following lines */
+    parse -> residues[i].reserve(next - lineEnd);
+
+    for(ptr = lineEnd + 1; ptr < next; ptr = lineEnd + 1) {
+      if((lineEnd = (const char *) memchr(ptr, '\n', next - ptr)) == NULL)
+        lineEnd = next;
+      line = cleanMappedLine(ptr, lineEnd, buffer, length);
+
+      /* First block is split using the same delimiters that in the header
+       * while the rest of them only use blank spaces and tabs */
+      for(j = 0; (j < length) && (isFastaDelimiter(line[j])); j++) ;
+      if(j == length)
+        continue;
+
+      for(token = &line[j]; (token < line + length) &&
+        (!isFastaDelimiter(*token)); token++) ;
+      parse -> residues[i].append(&line[j], token - &line[j]);
+
+      while(token < line + length) {
+        for(head = token + 1; (head < line + length) &&
+          (isBlankDelimiter(*head)); head++) ;
+        for(token = head; (token < line + length) &&
+          (!isBlankDelimiter(*token)); token++) ;
+        parse -> residues[i].append(head, token - head);
+      }
+    }
+  }
+}
+
+bool alignment::loadFastaAlignment(char *alignmentFile, mappedFile &input) {
+  /* FASTA file format parser working directly over a memory-mapped file.
+   * Sequences headers are located scanning chunks of the input file in
+   * parallel and then, sequences are parsed in parallel as well into memory
+   * allocated beforehand. Each task gets a similar amount of input bytes */
+
+  mappedParse parse;
+  long *starts;
+  int i, task;
+
+  parse.data = input.getData();
+  parse.begin = parse.data;
+  parse.end = parse.data + input.getSize();
+  parse.tasks = parallelTasks(input.getSize());
+
+  /* Store input file name for posterior uses in other formats */
+  filename.append("!Title ");
+  filename.append(alignmentFile);
+  filename.append(";");
+
+  /* Look for every sequence header */
+  parse.offsets = new long*[parse.tasks];
+  parse.counts = new int[parse.tasks];
+  threadPool::runShared(parse.tasks, findFastaHeaders, &parse);
+
+  starts = joinOffsets(parse.offsets, parse.counts, parse.tasks, sequenNumber);
+  delete [] parse.offsets;
+  delete [] parse.counts;
+
+  /* Lines before the first header do not belong to any sequence */
+  if(sequenNumber == 0) {
+    delete [] starts;
+    return false;
+  }
+
+  /* Allocate memory for the input alignmet */
+  seqsName  = new string[sequenNumber];
+  sequences = new string[sequenNumber];
+  seqsInfo  = new string[sequenNumber];
+
+  /* Split sequences among tasks depending on where they start */
+  if(parse.tasks > sequenNumber)
+    parse.tasks = sequenNumber;
+  parse.first = new int[parse.tasks + 1];
+  for(task = 0, i = 0; task < parse.tasks; task++) {
+    for( ; (i < sequenNumber) && (starts[i] < input.getSize() * task /
+      parse.tasks); i++) ;
+    parse.first[task] = i;
+  }
+  parse.first[parse.tasks] = sequenNumber;
+
+  parse.offsets = &starts;
+  parse.count = sequenNumber;
+  parse.number = sequenNumber;
+  parse.names = seqsName;
+  parse.residues = sequences;
+  parse.headers = seqsInfo;
+  threadPool::runShared(parse.tasks, parseFastaRecords, &parse);
+
+  /* Deallocate local memory */
+  delete [] parse.first;
+  delete [] starts;
 
   /* Check the matrix's content */
   return fillMatrices(false);
 }
 
-bool alignment::loadNexusAlignment(char *alignmentFile) {
+static bool isBlankMappedLine(const char *begin, const char *end,
+  string &buffer) {
+  /* Check whether utils::readLine would skip the given line */
+  int length;
+
+  /* Most of lines can be classified by its first character */
+  if((begin < end) && (*begin != ' ') && (*begin != '\t') &&
+    (*begin != '\r') && (*begin != '\0'))
+    return false;
+
+  cleanMappedLine(begin, end, buffer, length);
+  return (length == 0);
+}
+
+static void findPhylipLines(int task, void *argument) {
+  /* Look for non-blank lines in a chunk of the input file. Lines are
+   * assigned to the chunk where they start */
+  mappedParse *parse = (mappedParse *) argument;
+  const char *ptr, *end, *lineEnd;
+  int capacity = 256;
+  string buffer;
+
+  ptr = parse -> begin + (parse -> end - parse -> begin) * task / parse -> tasks;
+  end = parse -> begin + (parse -> end - parse -> begin) * (task + 1) /
+    parse -> tasks;
+
+  parse -> offsets[task] = new long[capacity];
+  parse -> counts[task] = 0;
+
+  /* Move to the first line starting in the chunk */
+  if((ptr != parse -> begin) && (ptr[-1] != '\n')) {
+    if((ptr = (const char *) memchr(ptr, '\n', parse -> end - ptr)) == NULL)
+      return;
+    ptr++;
+  }
+
+  for( ; ptr < end; ptr = lineEnd + 1) {
+    if((lineEnd = (const char *) memchr(ptr, '\n', parse -> end - ptr)) ==
+      NULL)
+      lineEnd = parse -> end;
+
+    if(!isBlankMappedLine(ptr, lineEnd, buffer))
+      appendOffset(parse -> offsets[task], parse -> counts[task], capacity,
+        ptr - parse -> data);
+  }
+}
+
+static void parsePhylipSequences(int task, void *argument) {
+  /* Parse the sequences assigned to a task. In interleaved files, every
+   * block has one line per sequence so lines are assigned cyclically. The
+   * first block also contains the sequences names */
+  mappedParse *parse = (mappedParse *) argument;
+  const char *ptr, *line, *lineEnd, *head, *token;
+  long *lines = parse -> offsets[0];
+  int i, j, length;
+  string buffer;
+  bool named;
+
+  for(i = parse -> first[task]; i < parse -> first[task + 1]; i++) {
+    for(j = i; j < parse -> count; j += parse -> number) {
+      ptr = parse -> data + lines[j];
+      if((lineEnd = (const char *) memchr(ptr, '\n', parse -> end - ptr)) ==
+        NULL)
+        lineEnd = parse -> end;
+      line = cleanMappedLine(ptr, lineEnd, buffer, length);
+
+      /* Split the line in blocks. In the first block, the first one is the
+       * sequence name */
+      named = (j >= parse -> number);
+      for(token = line; token < line + length; ) {
+        for(head = token; (head < line + length) &&
+          (isBlankDelimiter(*head)); head++) ;
+        for(token = head; (token < line + length) &&
+          (!isBlankDelimiter(*token)); token++) ;
+        if(token == head)
+          break;
+
+        if(!named)
+          parse -> names[i].append(head, token - head);
+        else
+          parse -> residues[i].append(head, token - head);
+        named = true;
+      }
+    }
+  }
+}
+
+bool alignment::loadPhylipAlignment(char *alignmentFile, mappedFile &input) {
+  /* PHYLIP/PHYLIP 4 (Sequential) file format parser working directly over a
+   * memory-mapped file. Non-blank lines are located scanning chunks of the
+   * input file in parallel and then, sequences are parsed in parallel from
+   * the lines belonging to each one */
+
+  mappedParse parse;
+  const char *ptr, *line, *lineEnd, *head, *token;
+  string buffer, numbers[2];
+  long *lines;
+  int i, length, task;
+
+  parse.data = input.getData();
+  parse.end = parse.data + input.getSize();
+
+  /* Store some data about filename for possible uses in other formats */
+  filename.append("!Title ");
+  filename.append(alignmentFile);
+  filename.append(";");
+
+  /* Look for the first valid line */
+  for(ptr = parse.data; ; ptr = lineEnd + 1) {
+    /* If the file end is reached without a valid line, warn about it */
+    if((lineEnd = (const char *) memchr(ptr, '\n', parse.end - ptr)) == NULL)
+      return false;
+    if(!isBlankMappedLine(ptr, lineEnd, buffer))
+      break;
+  }
+
+  /* Read the input sequences and residues for each sequence numbers */
+  line = cleanMappedLine(ptr, lineEnd, buffer, length);
+  for(i = 0, token = line; i < 2; i++) {
+    for(head = token; (head < line + length) &&
+      (isBlankDelimiter(*head)); head++) ;
+    for(token = head; (token < line + length) &&
+      (!isBlankDelimiter(*token)); token++) ;
+    numbers[i].assign(head, token - head);
+  }
+  sequenNumber = atoi(numbers[0].c_str());
+  residNumber = atoi(numbers[1].c_str());
+
+  /* If something is wrong about the sequences or/and residues number,
+   * return an error to warn about that */
+  if((sequenNumber == 0) || (residNumber == 0))
+    return false;
+
+  /* Look for every non-blank line after the first one */
+  parse.begin = lineEnd + 1;
+  parse.tasks = parallelTasks(parse.end - parse.begin);
+  parse.offsets = new long*[parse.tasks];
+  parse.counts = new int[parse.tasks];
+  threadPool::runShared(parse.tasks, findPhylipLines, &parse);
+
+  lines = joinOffsets(parse.offsets, parse.counts, parse.tasks, parse.count);
+  delete [] parse.offsets;
+  delete [] parse.counts;
+
+  /* Allocate memory  for the input data */
+  sequences  = new string[sequenNumber];
+  seqsName   = new string[sequenNumber];
+
+  for(i = 0; i < sequenNumber; i++)
+    sequences[i].reserve(residNumber);
+
+  /* Split sequences among tasks */
+  if(parse.tasks > sequenNumber)
+    parse.tasks = sequenNumber;
+  parse.first = new int[parse.tasks + 1];
+  for(task = 0; task <= parse.tasks; task++)
+    parse.first[task] = (int) ((long) sequenNumber * task / parse.tasks);
+
+  parse.offsets = &lines;
+  parse.number = sequenNumber;
+  parse.names = seqsName;
+  parse.residues = sequences;
+  threadPool::runShared(parse.tasks, parsePhylipSequences, &parse);
+
+  /* Deallocate local memory */
+  delete [] parse.first;
+  delete [] lines;
+
+  /* Check the matrix's content */
+  return fillMatrices(true);
+}
+
+bool alignment::loadNexusAlignment(char *alignmentFile, lineReader &file) {
 
   /* NEXUS file format parser */
   char *frag = NULL, *str = NULL, *line = NULL;
   int i, pos, state, firstBlock;
-  ifstream file;
-
-  /* Check the file and its content */
-  file.open(alignmentFile, ifstream::in);
-  if(!utils::checkFile(file))
-    return false;
 
   /* Store input file name for posterior uses in other formats */
   /* We store the file name */
@@ -788,12 +1136,8 @@ bool alignment::loadNexusAlignment(char *alignmentFile) {
   state = false;
   do {
 
-    /* Destroy previous assigned memory */
-    if (line != NULL)
-      delete [] line;
-
     /* Read line in a safer way */
-    line = utils::readLine(file);
+    line = file.readLine();
     if (line == NULL)
       continue;
 
@@ -848,12 +1192,8 @@ bool alignment::loadNexusAlignment(char *alignmentFile) {
   firstBlock = true;
 
   while(!file.eof()) {
-    /* Destroy previous assigned memory */
-    if (line != NULL)
-      delete [] line;
-
     /* Read line in a safer way */
-    line = utils::readLine(file);
+    line = file.readLine();
     if (line == NULL)
       continue;
 
@@ -899,10 +1239,6 @@ bool alignment::loadNexusAlignment(char *alignmentFile) {
       firstBlock = false;
   }
 
-  /* Deallocate memory */
-  if (line != NULL)
-    delete [] line;
-
   /* Close the input file */
   file.close();
 
@@ -910,18 +1246,12 @@ bool alignment::loadNexusAlignment(char *alignmentFile) {
   return fillMatrices(true);
 }
 
-bool alignment::loadMegaNonInterleavedAlignment(char *alignmentFile) {
+bool alignment::loadMegaNonInterleavedAlignment(char *alignmentFile, lineReader &file) {
   /* MEGA sequential file format parser */
 
   char *frag = NULL, *str = NULL, *line = NULL;
-  ifstream file;
   int i;
 
-  /* Check the file and its content */
-  file.open(alignmentFile, ifstream::in);
-  if(!utils::checkFile(file))
-    return false;
-
   /* Filename is stored as a title for MEGA input alignment.
    * If it is detected later a label "TITLE" in input file, this information
    * will be replaced for that one */
@@ -931,7 +1261,7 @@ bool alignment::loadMegaNonInterleavedAlignment(char *alignmentFile) {
 
   /* Skip first valid line */
   do {
-    line = utils::readLine(file);
+    line = file.scanLine();
   } while ((line == NULL) && (!file.eof()));
 
   /* If the file end is reached without a valid line, warn about it */
@@ -941,12 +1271,8 @@ bool alignment::loadMegaNonInterleavedAlignment(char *alignmentFile) {
   /* Try to get input alignment information */
   while(!file.eof()) {
 
-    /* Destroy previously allocated memory */
-    if (line != NULL)
-      delete [] line;
-
     /* Read a new line in a safe way */
-    line = utils::readLine(file);
+    line = file.scanLine();
     if (line == NULL)
       continue;
 
@@ -991,7 +1317,7 @@ bool alignment::loadMegaNonInterleavedAlignment(char *alignmentFile) {
 
     /* Check whether input line is valid or not */
     if (line == NULL) {
-      line = utils::readLine(file);
+      line = file.scanLine();
       continue;
     }
 
@@ -999,35 +1325,26 @@ bool alignment::loadMegaNonInterleavedAlignment(char *alignmentFile) {
     if (!strncmp(line, "#", 1))
       sequenNumber++;
 
-    /* Destroy previously allocated memory */
-    if (line != NULL)
-      delete [] line;
-
     /* Read a new line in a safe way */
-    line = utils::readLine(file);
+    line = file.scanLine();
 
   } while(!file.eof());
 
   /* Move file pointer to the beginner */
-  file.clear();
-  file.seekg(0);
+  file.rewind();
 
   /* Allocate memory */
   seqsName  = new string[sequenNumber];
   sequences = new string[sequenNumber];
 
   /* Skip first line */
-  line = utils::readLine(file);
+  line = file.readLine();
 
   /* Skip lines until first sequence name is found */
   while(!file.eof()) {
 
-    /* Destroy previously allocated memory */
-    if (line != NULL)
-      delete [] line;
-
     /* Read a new line in a safe way */
-    line = utils::readLine(file);
+    line = file.readLine();
     if (line == NULL)
       continue;
 
@@ -1046,15 +1363,13 @@ bool alignment::loadMegaNonInterleavedAlignment(char *alignmentFile) {
 
     /* Skip blank lines */
     if (line == NULL) {
-      line = utils::readLine(file);
+      line = file.readLine();
       continue;
     }
 
     /* Skip lines with comments */
     if (!strncmp(line, "!", 1)) {
-      /* Deallocate memory and read a new line */
-      delete [] line;
-      line = utils::readLine(file);
+      line = file.readLine();
       continue;
     }
 
@@ -1064,10 +1379,7 @@ bool alignment::loadMegaNonInterleavedAlignment(char *alignmentFile) {
     /* Skip lines with only comments */
     if (frag == NULL) {
 
-      /* Deallocate memory and read a new line */
-      if (line != NULL)
-        delete [] line;
-      line = utils::readLine(file);
+      line = file.readLine();
       continue;
     }
 
@@ -1091,35 +1403,22 @@ bool alignment::loadMegaNonInterleavedAlignment(char *alignmentFile) {
     if (frag != NULL)
       delete [] frag;
 
-    if (line != NULL)
-      delete [] line;
-
     /* Read a new line in a safe way */
-    line = utils::readLine(file);
+    line = file.readLine();
   }
 
   /* Close input file */
   file.close();
 
-  /* Deallocate dynamic memory */
-  if (line != NULL)
-    delete [] line;
-
   /* Check the matrix's content */
   return fillMatrices(true);
 }
 
-bool alignment::loadMegaInterleavedAlignment(char *alignmentFile) {
+bool alignment::loadMegaInterleavedAlignment(char *alignmentFile, lineReader &file) {
   /* MEGA interleaved file format parser */
 
   char *frag = NULL, *str = NULL, *line = NULL;
   int i, firstBlock = true;
-  ifstream file;
-
-  /* Check the file and its content */
-  file.open(alignmentFile, ifstream::in);
-  if(!utils::checkFile(file))
-    return false;
 
   /* Filename is stored as a title for MEGA input alignment.
    * If it is detected later a label "TITLE" in input file, this information
@@ -1130,7 +1429,7 @@ bool alignment::loadMegaInterleavedAlignment(char *alignmentFile) {
 
   /* Skip first valid line */
   do {
-    line = utils::readLine(file);
+    line = file.scanLine();
   } while ((line == NULL) && (!file.eof()));
 
   /* If the file end is reached without a valid line, warn about it */
@@ -1140,12 +1439,8 @@ bool alignment::loadMegaInterleavedAlignment(char *alignmentFile) {
   /* Try to get input alignment information */
   while(!file.eof()) {
 
-    /* Destroy previously allocated memory */
-    if (line != NULL)
-      delete [] line;
-
     /* Read a new line in a safe way */
-    line = utils::readLine(file);
+    line = file.scanLine();
     if (line == NULL)
       continue;
 
@@ -1188,12 +1483,8 @@ bool alignment::loadMegaInterleavedAlignment(char *alignmentFile) {
     if(!strncmp(line, "#", 1))
       sequenNumber++;
 
-    /* Deallocate dynamic memory */
-    if(line != NULL)
-      delete [] line;
-
     /* Read lines in a safe way */
-    line = utils::readLine(file);
+    line = file.scanLine();
 
     /* If a blank line is detected means first block of sequences is over */
     /* Then, break counting sequences loop */
@@ -1202,25 +1493,20 @@ bool alignment::loadMegaInterleavedAlignment(char *alignmentFile) {
   }
 
   /* Finish to preprocess the input file. */
-  file.clear();
-  file.seekg(0);
+  file.rewind();
 
   /* Allocate memory */
   seqsName  = new string[sequenNumber];
   sequences = new string[sequenNumber];
 
   /* Skip first line */
-  line = utils::readLine(file);
+  line = file.readLine();
 
   /* Skip lines until first # flag is reached */
   while(!file.eof()) {
 
-    /* Deallocate previously used dynamic memory */
-    if (line != NULL)
-      delete [] line;
-
     /* Read line in a safer way */
-    line = utils::readLine(file);
+    line = file.readLine();
 
     /* Determine whether a # flag has been found in current string */
     if (line != NULL)
@@ -1236,14 +1522,12 @@ bool alignment::loadMegaInterleavedAlignment(char *alignmentFile) {
 
     if (line == NULL) {
     /* Read line in a safer way */
-    line = utils::readLine(file);
+    line = file.readLine();
     continue;
     }
 
     if (!strncmp(line, "!", 1)) {
-      /* Deallocate memory and read a new line */
-      delete [] line;
-      line = utils::readLine(file);
+      line = file.readLine();
       continue;
     }
 
@@ -1270,11 +1554,8 @@ bool alignment::loadMegaInterleavedAlignment(char *alignmentFile) {
     if (frag != NULL)
       delete [] frag;
 
-    if (line != NULL)
-      delete [] line;
-
     /* Read line in a safer way */
-    line = utils::readLine(file);
+    line = file.readLine();
 
     i = (i + 1) % sequenNumber;
     if (i == 0)
@@ -1284,27 +1565,17 @@ bool alignment::loadMegaInterleavedAlignment(char *alignmentFile) {
   /* Close input file */
   file.close();
 
-  /* Deallocate local memory */
-  if (line != NULL)
-    delete [] line;
-
   /* Check the matrix's content */
   return fillMatrices(true);
 }
 
-bool alignment::loadNBRF_PirAlignment(char *alignmentFile) {
+bool alignment::loadNBRF_PirAlignment(char *alignmentFile, lineReader &file) {
   /* NBRF/PIR file format parser */
 
   bool seqIdLine, seqLines;
   char *str, *line = NULL; 
-  ifstream file;
   int i;
 
-  /* Check the file and its content */
-  file.open(alignmentFile, ifstream::in);
-  if(!utils::checkFile(file))
-    return false;
-
   /* Store input file name for posterior uses in other formats */
   filename.append("!Title ");
   filename.append(alignmentFile);
@@ -1314,12 +1585,8 @@ bool alignment::loadNBRF_PirAlignment(char *alignmentFile) {
   sequenNumber = 0;
   while(!file.eof()) {
 
-    /* Deallocate previously used dinamic memory */
-    if (line != NULL)
-      delete [] line;
-
     /* Read lines in a safe way */
-    line = utils::readLine(file);
+    line = file.scanLine();
     if (line == NULL)
       continue;
 
@@ -1334,8 +1601,7 @@ bool alignment::loadNBRF_PirAlignment(char *alignmentFile) {
   }
 
   /* Finish to preprocess the input file. */
-  file.clear();
-  file.seekg(0);
+  file.rewind();
 
   /* Allocate memory for the input alignmet */
   sequences = new string[sequenNumber];
@@ -1350,12 +1616,8 @@ bool alignment::loadNBRF_PirAlignment(char *alignmentFile) {
   /* Read the entire input file */
   while(!file.eof()) {
 
-    /* Deallocate local memory */
-    if (line != NULL)
-      delete [] line;
-
     /* Read lines in a safe way */
-    line = utils::readLine(file);
+    line = file.readLine();
     if (line == NULL)
       continue;
 
@@ -1408,19 +1670,232 @@ bool alignment::loadNBRF_PirAlignment(char *alignmentFile) {
   /* Close the input file */
   file.close();
 
-  /* Deallocate dinamic memory */
-  if (line != NULL)
-    delete [] line;
-
   /* Check the matrix's content */
   return fillMatrices(true);
 }
 
+/* Binary alignment container. It starts with a text line, so the format is
+ * detected like any other one, followed by a fixed header which gives the
+ * offset, from the file beginning, of every section. Sections are aligned
+ * to 8 bytes. Strings (names, headers, residues, title) are stored as
+ * tables: "count + 1" offsets followed by all strings one after another */
+struct binaryHeader {
+  char magic[16];
+  int32_t byteOrder;
+  int32_t version;
+  int32_t sequences;
+  int32_t residues;
+  int32_t dataType;
+  int32_t aligned;
+  int32_t format;
+  int32_t flags;
+  int64_t names;
+  int64_t info;
+  int64_t residuesData;
+  int64_t title;
+  int64_t gaps;
+  int64_t identities;
+  int64_t size;
+};
+
+static const char binaryMagic[16] = "#TRIMALBIN 1\n";
+
+static inline int64_t binaryPadding(int64_t size) {
+  /* Bytes needed to align a section of the given size */
+  return (8 - (size % 8)) % 8;
+}
+
+static bool binaryFormat(int format) {
+  /* Check the original format stored in a binary alignment is one of the
+   * input formats it could have been read from */
+  switch(format) {
+    case 1: case 3: case 8: case 11: case 12: case 17: case 21: case 22:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static bool readBinaryTable(const char *data, int64_t offset, int64_t size,
+  int count, string *table) {
+  /* Load a table of strings checking it lays inside the file */
+  const int64_t *limits;
+  const char *chars;
+  int i;
+
+  if((offset < 0) || (offset + (int64_t) sizeof(int64_t) * (count + 1) > size))
+    return false;
+
+  limits = (const int64_t *) (data + offset);
+  chars = data + offset + sizeof(int64_t) * (count + 1);
+
+  if((limits[0] != 0) || (chars - data + limits[count] > size))
+    return false;
+
+  for(i = 0; i < count; i++) {
+    if(limits[i + 1] < limits[i])
+      return false;
+    table[i].assign(chars + limits[i], limits[i + 1] - limits[i]);
+  }
+  return true;
+}
+
+bool alignment::loadBinaryAlignment(char *alignmentFile, mappedFile &input) {
+  /* Binary alignment loader. Data is copied from the memory-mapped file
+   * without any parsing or validation of its residues, which was done when
+   * the file was generated. Only its layout is checked, so a damaged file
+   * can not lead to read out of the loaded alignment */
+
+  const char *data = input.getData();
+  const binaryHeader *header = (const binaryHeader *) data;
+  string title[2];
+  const int32_t *gaps;
+  const float *values;
+  int64_t k, size = input.getSize();
+  int i, j;
+
+  /* Check file header */
+  if((size < (int64_t) sizeof(binaryHeader)) ||
+    (memcmp(header -> magic, binaryMagic, sizeof(binaryMagic))) ||
+    (header -> byteOrder != 0x01020304) || (header -> version != 1) ||
+    (header -> size != size) || (header -> sequences <= 0) ||
+    (header -> residues < 0) || (header -> dataType < 0) ||
+    (header -> dataType > AAType) || (!binaryFormat(header -> format))) {
+    cerr << endl << "ERROR: Binary alignment \"" << alignmentFile << "\" is "
+      << "either damaged or generated by a not compatible version." << endl;
+    return false;
+  }
+
+  sequenNumber = header -> sequences;
+  residNumber  = header -> residues;
+  dataType     = header -> dataType;
+  isAligned    = header -> aligned;
+
+  /* Alignment behaves as if it had been read from its original format */
+  iformat      = header -> format;
+  oformat      = header -> format;
+
+  seqsName  = new string[sequenNumber];
+  sequences = new string[sequenNumber];
+  if(header -> flags & BINARYINFO)
+    seqsInfo = new string[sequenNumber];
+
+  if((!readBinaryTable(data, header -> names, size, sequenNumber, seqsName)) ||
+    (!readBinaryTable(data, header -> residuesData, size, sequenNumber,
+      sequences)) || (!readBinaryTable(data, header -> title, size, 2, title)) ||
+    ((seqsInfo != NULL) && (!readBinaryTable(data, header -> info, size,
+      sequenNumber, seqsInfo)))) {
+    cerr << endl << "ERROR: Binary alignment \"" << alignmentFile << "\" is "
+      << "damaged." << endl;
+    return false;
+  }
+  filename = title[0];
+  aligInfo = title[1];
+
+  /* Every aligned sequence should have as many residues as columns */
+  for(i = 0; (i < sequenNumber) && (isAligned); i++)
+    if((int) sequences[i].size() != residNumber) {
+      cerr << endl << "ERROR: Binary alignment \"" << alignmentFile << "\" is "
+        << "damaged." << endl;
+      return false;
+    }
+
+  residuesNumber = new int[sequenNumber];
+  for(i = 0; i < sequenNumber; i++)
+    residuesNumber[i] = sequences[i].size();
+
+  /* Initialize selected columns and sequences as fillMatrices does */
+  if(isAligned) {
+    saveResidues = new int[residNumber];
+    for(i = 0; i < residNumber; i++)
+      saveResidues[i] = i;
+
+    saveSequences = new int[sequenNumber];
+    for(i = 0; i < sequenNumber; i++)
+      saveSequences[i] = i;
+  }
+
+  /* Gaps and indeterminations per column, if they are available, are used
+   * once gaps statistics are requested */
+  if((header -> flags & BINARYGAPS) && (isAligned) && (header -> gaps > 0) &&
+    (header -> gaps + (int64_t) sizeof(int32_t) * 2 * residNumber <= size)) {
+    gaps = (const int32_t *) (data + header -> gaps);
+    storedGaps = new int[residNumber];
+    storedIndets = new int[residNumber];
+    for(i = 0; i < residNumber; i++) {
+      storedGaps[i] = gaps[i];
+      storedIndets[i] = gaps[residNumber + i];
+    }
+  }
+
+  /* Sequences identities are stored as the upper triangle of the matrix */
+  k = (int64_t) sequenNumber * (sequenNumber - 1) / 2;
+  if((header -> flags & BINARYIDENTITY) && (header -> identities > 0) &&
+    (header -> identities + (int64_t) sizeof(float) * k <= size)) {
+    values = (const float *) (data + header -> identities);
+    identities = new identityMatrix(sequenNumber, 1);
+    for(i = 0, k = 0; i < sequenNumber; i++)
+      for(j = i + 1; j < sequenNumber; j++, k++)
+        identities -> set(i, j, values[k]);
+  }
+
+  return true;
+}
+
+static void writeResidues(ostream &file, const string &sequence, int position,
+  int length, bool reversed, bool upperCase, bool lowerCase) {
+  /* Write up to the given number of residues from the given position on.
+   * Reversed sequences are read backwards and case is changed on the fly,
+   * so sequences are never copied before being written */
+  const char *data = sequence.data();
+  char block[256];
+  int size = (int) sequence.size(), i, n;
+
+  if(position >= size)
+    return;
+  if(length > size - position)
+    length = size - position;
+
+  /* Most of times, residues can be written directly */
+  if((!reversed) && (!upperCase) && (!lowerCase)) {
+    file.write(data + position, length);
+    return;
+  }
+
+  for( ; length > 0; position += n, length -= n) {
+    n = (length < (int) sizeof(block)) ? length : (int) sizeof(block);
+    for(i = 0; i < n; i++) {
+      block[i] = (reversed) ? data[size - 1 - position - i] : data[position + i];
+      if(upperCase)
+        block[i] = toupper(block[i]);
+      else if(lowerCase)
+        block[i] = tolower(block[i]);
+    }
+    file.write(block, n);
+  }
+}
+
+static void writePadded(ostream &file, const string &text, int length,
+  int width) {
+  /* Write a text cut to the given length and fill it with blank spaces up
+   * to the given width */
+  static const char blanks[] = "                                ";
+  int n;
+
+  if(length > (int) text.size())
+    length = (int) text.size();
+  file.write(text.data(), length);
+
+  for(width -= length; width > 0; width -= n) {
+    n = (width < (int) sizeof(blanks) - 1) ? width : (int) sizeof(blanks) - 1;
+    file.write(blanks, n);
+  }
+}
+
 void alignment::alignmentPhylipToFile(ostream &file) {
   /* Generate output alignment in PHYLIP/PHYLIP 4 format (sequential) */
 
   int i, j, maxLongName;
-  string *tmpMatrix;
 
   /* Check whether sequences in the alignment are aligned or not.
    * Warn about it if there are not aligned. */
@@ -1430,15 +1905,6 @@ void alignment::alignmentPhylipToFile(ostream &file) {
     return ;
   }
 
-  /* Allocate local memory for generating output alignment */
-  tmpMatrix = new string[sequenNumber];
-
-  /* Depending on alignment orientation: forward or reverse. Copy directly
-   * sequence information or get firstly the reversed sequences and then
-   * copy it into local memory */
-  for(i = 0; i < sequenNumber; i++)
-    tmpMatrix[i] = (!reverse) ? sequences[i] : utils::getReverse(sequences[i]);
-
   /* Depending on if short name flag is activated (limits sequence name up to
    * 10 characters) or not, get maximum sequence name length */
   maxLongName = PHYLIPDISTANCE;
@@ -1447,31 +1913,31 @@ void alignment::alignmentPhylipToFile(ostream &file) {
 
   /* Generating output alignment */
   /* First Line: Sequences Number & Residued Number */
-  file << " " << sequenNumber << " " << residNumber << endl;
+  file << " " << sequenNumber << " " << residNumber << "\n";
 
   /* First Block: Sequences Names & First 60 residues */
-  for(i = 0; i < sequenNumber; i++)
-    file << setw(maxLongName + 3) << left << seqsName[i].substr(0, maxLongName)
-      << tmpMatrix[i].substr(0, 60) << endl;
-  file << endl;
+  for(i = 0; i < sequenNumber; i++) {
+    writePadded(file, seqsName[i], maxLongName, maxLongName + 3);
+    writeResidues(file, sequences[i], 0, 60, reverse, upperCase, lowerCase);
+    file << "\n";
+  }
+  file << "\n";
 
   /* Rest of blocks: Print 60 residues per each blocks of sequences */
   for(i = 60; i < residNumber; i += 60) {
-    for(j = 0; j < sequenNumber; j++)
-      file << tmpMatrix[j].substr(i, 60) << endl;
-    file << endl;
+    for(j = 0; j < sequenNumber; j++) {
+      writeResidues(file, sequences[j], i, 60, reverse, upperCase, lowerCase);
+      file << "\n";
+    }
+    file << "\n";
   }
-  file << endl;
-
-  /* Deallocate local memory */
-  delete [] tmpMatrix;
+  file << "\n";
 }
 
 void alignment::alignmentPhylip3_2ToFile(ostream &file) {
   /* Generate output alignment in PHYLIP 3.2 format (interleaved) */
 
   int i, j, k, maxLongName;
-  string *tmpMatrix;
 
   /* Check whether sequences in the alignment are aligned or not.
    * Warn about it if there are not aligned. */
@@ -1481,15 +1947,6 @@ void alignment::alignmentPhylip3_2ToFile(ostream &file) {
     return ;
   }
 
-  /* Allocate local memory for generating output alignment */
-  tmpMatrix = new string[sequenNumber];
-
-  /* Depending on alignment orientation: forward or reverse. Copy directly
-   * sequence information or get firstly the reversed sequences and then
-   * copy it into local memory */
-  for(i = 0; i < sequenNumber; i++)
-    tmpMatrix[i] = (!reverse) ? sequences[i] : utils::getReverse(sequences[i]);
-
   /* Depending on if short name flag is activated (limits sequence name up to
    * 10 characters) or not, get maximum sequence name length */
   maxLongName = PHYLIPDISTANCE;
@@ -1498,37 +1955,35 @@ void alignment::alignmentPhylip3_2ToFile(ostream &file) {
 
   /* Generating output alignment */
   /* First Line: Sequences Number & Residued Number */
-  file << " " << sequenNumber << " " << residNumber << endl;
+  file << " " << sequenNumber << " " << residNumber << "\n";
 
   /* Alignment */
   /* For each sequence, print its identifier and then the sequence itself in
    * blocks of 50 residues */
   for(i = 0; i < sequenNumber; i++) {
     /* Sequence Name */
-    file << setw(maxLongName + 3) << left << seqsName[i].substr(0, maxLongName);
+    writePadded(file, seqsName[i], maxLongName, maxLongName + 3);
     /* Sequence. Each line contains a block of 5 times 10 residues. */
     for(j = 0; j < residNumber; j += 50) {
-      for(k = j; (k < residNumber) && (k < (j + 50)); k += 10)
-        file << sequences[i].substr(k, 10) << " ";
-      file << endl;
+      for(k = j; (k < residNumber) && (k < (j + 50)); k += 10) {
+        writeResidues(file, sequences[i], k, 10, reverse, upperCase, lowerCase);
+        file << " ";
+      }
+      file << "\n";
       /* If the sequences end has not been reached, print black spaces
        * to follow format specifications */
       if((j + 50) < residNumber)
-        file << setw(maxLongName + 3) << " ";
+        writePadded(file, "", 0, maxLongName + 3);
     }
     /* Print a blank line to mark sequences separation */
-    file << endl;
+    file << "\n";
   }
-
-  /* Deallocate local memory */
-  delete [] tmpMatrix;
 }
 
 void alignment::alignmentPhylip_PamlToFile(ostream &file) {
   /* Generate output alignment in PHYLIP format compatible with PAML program */
 
   int i, maxLongName;
-  string *tmpMatrix;
 
   /* Check whether sequences in the alignment are aligned or not.
    * Warn about it if there are not aligned. */
@@ -1538,15 +1993,6 @@ void alignment::alignmentPhylip_PamlToFile(ostream &file) {
     return ;
   }
 
-  /* Allocate local memory for generating output alignment */
-  tmpMatrix = new string[sequenNumber];
-
-  /* Depending on alignment orientation: forward or reverse. Copy directly
-   * sequence information or get firstly the reversed sequences and then
-   * copy it into local memory */
-  for(i = 0; i < sequenNumber; i++)
-    tmpMatrix[i] = (!reverse) ? sequences[i] : utils::getReverse(sequences[i]);
-
   /* Depending on if short name flag is activated (limits sequence name up to
    * 10 characters) or not, get maximum sequence name length */
   maxLongName = PHYLIPDISTANCE;
@@ -1555,24 +2001,23 @@ void alignment::alignmentPhylip_PamlToFile(ostream &file) {
 
   /* Generating output alignment */
   /* First Line: Sequences Number & Residued Number */
-  file << " " << sequenNumber << " " << residNumber << endl;
+  file << " " << sequenNumber << " " << residNumber << "\n";
 
   /* Print alignment */
   /* Print sequences name follow by the sequence itself in the same line */
-  for(i = 0; i < sequenNumber; i++)
-    file << setw(maxLongName + 3) << left << seqsName[i].substr(0, maxLongName)
-      << sequences[i] << endl;
-  file << endl;
-
-  /* Deallocate local memory */
-  delete [] tmpMatrix;
+  for(i = 0; i < sequenNumber; i++) {
+    writePadded(file, seqsName[i], maxLongName, maxLongName + 3);
+    writeResidues(file, sequences[i], 0, residNumber, reverse, upperCase,
+      lowerCase);
+    file << "\n";
+  }
+  file << "\n";
 }
 
 void alignment::alignmentClustalToFile(ostream &file) {
   /* Generate output alignment in CLUSTAL format */
 
   int i, j, maxLongName = 0;
-  string *tmpMatrix;
 
   /* Check whether sequences in the alignment are aligned or not.
    * Warn about it if there are not aligned. */
@@ -1582,53 +2027,33 @@ void alignment::alignmentClustalToFile(ostream &file) {
     return ;
   }
 
-  /* Allocate local memory for generating output alignment */
-  tmpMatrix = new string[sequenNumber];
-
-  /* Depending on alignment orientation: forward or reverse. Copy directly
-   * sequence information or get firstly the reversed sequences and then
-   * copy it into local memory */
-  for(i = 0; i < sequenNumber; i++)
-    tmpMatrix[i] = (!reverse) ? sequences[i] : utils::getReverse(sequences[i]);
-
   /* Compute maximum sequences name length */
   for(i = 0; (i < sequenNumber) && (!shortNames); i++)
     maxLongName = utils::max(maxLongName, seqsName[i].size());
 
   /* Print alignment header */
   if((aligInfo.size() != 0)  && (iformat == oformat))
-    file << aligInfo << endl << endl;
+    file << aligInfo << "\n\n";
   else
-    file << "CLUSTAL multiple sequence alignment" << endl << endl;
+    file << "CLUSTAL multiple sequence alignment\n\n";
 
   /* Print alignment itself */
   /* Print as many blocks as it is needed of lines composed
    * by sequences name and 60 residues */
   for(j = 0; j < residNumber; j += 60) {
-    for(i = 0; i < sequenNumber; i++)
-      file << setw(maxLongName + 5) << left << seqsName[i]
-        << tmpMatrix[i].substr(j, 60) << endl;
-    file << endl << endl;
+    for(i = 0; i < sequenNumber; i++) {
+      writePadded(file, seqsName[i], seqsName[i].size(), maxLongName + 5);
+      writeResidues(file, sequences[i], j, 60, reverse, upperCase, lowerCase);
+      file << "\n";
+    }
+    file << "\n\n";
   }
-
-  /* Deallocate local memory */
-  delete [] tmpMatrix;
 }
 
 void alignment::alignmentFastaToFile(ostream &file) {
   /* Generate output alignment in FASTA format. Sequences can be unaligned. */
 
   int i, j, maxLongName;
-  string *tmpMatrix;
-
-  /* Allocate local memory for generating output alignment */
-  tmpMatrix = new string[sequenNumber];
-
-  /* Depending on alignment orientation: forward or reverse. Copy directly
-   * sequence information or get firstly the reversed sequences and then
-   * copy it into local memory */
-  for(i = 0; i < sequenNumber; i++)
-    tmpMatrix[i] = (!reverse) ? sequences[i] : utils::getReverse(sequences[i]);
 
   /* Depending on if short name flag is activated (limits sequence name up to
    * 10 characters) or not, get maximum sequence name length. Consider those
@@ -1648,23 +2073,27 @@ void alignment::alignmentFastaToFile(ostream &file) {
     }
   /* Print alignment. First, sequences name id and then the sequences itself */
   for(i = 0; i < sequenNumber; i++) {
-    if (!keepHeader)
-      file << ">" << seqsName[i].substr(0, maxLongName) << endl;
-    else if (seqsInfo != NULL)
-      file << ">" << seqsInfo[i].substr(0, maxLongName) << endl;
-    for(j = 0; j < residuesNumber[i]; j+= 60)
-      file << tmpMatrix[i].substr(j, 60) << endl;
+    if (!keepHeader) {
+      file << ">";
+      writePadded(file, seqsName[i], maxLongName, 0);
+      file << "\n";
+    }
+    else if (seqsInfo != NULL) {
+      file << ">";
+      writePadded(file, seqsInfo[i], maxLongName, 0);
+      file << "\n";
+    }
+    for(j = 0; j < residuesNumber[i]; j+= 60) {
+      writeResidues(file, sequences[i], j, 60, reverse, upperCase, lowerCase);
+      file << "\n";
+    }
   }
-
-  /* Deallocate local memory */
-  delete [] tmpMatrix;
 }
 
 void alignment::alignmentNexusToFile(ostream &file) {
   /* Generate output alignment in NEXUS format setting only alignment block */
 
   int i, j, k, maxLongName = 0;
-  string *tmpMatrix;
 
   /* Check whether sequences in the alignment are aligned or not.
    * Warn about it if there are not aligned. */
@@ -1674,15 +2103,6 @@ void alignment::alignmentNexusToFile(ostream &file) {
     return ;
   }
 
-  /* Allocate local memory for generating output alignment */
-  tmpMatrix = new string[sequenNumber];
-
-  /* Depending on alignment orientation: forward or reverse. Copy directly
-   * sequence information or get firstly the reversed sequences and then
-   * copy it into local memory */
-  for(i = 0; i < sequenNumber; i++)
-    tmpMatrix[i] = (!reverse) ? sequences[i] : utils::getReverse(sequences[i]);
-
   /* Compute maximum sequences name length */
   for(i = 0; (i < sequenNumber) && (!shortNames); i++)
     maxLongName = utils::max(maxLongName, seqsName[i].size());
@@ -1695,8 +2115,8 @@ void alignment::alignmentNexusToFile(ostream &file) {
     aligInfo.erase(aligInfo.find(";"), 1);
 
   /* Print Alignment header */
-  file << "#NEXUS" << endl << "BEGIN DATA;" << endl << " DIMENSIONS NTAX="
-    << sequenNumber << " NCHAR=" << residNumber <<";" << endl;
+  file << "#NEXUS\nBEGIN DATA;\n DIMENSIONS NTAX="
+    << sequenNumber << " NCHAR=" << residNumber << ";\n";
 
   /* Print alignment datatype */
   if ((dataType == DNAType) || (dataType == DNADeg))
@@ -1720,35 +2140,35 @@ void alignment::alignmentNexusToFile(ostream &file) {
 
     i = j + 1;
   }
-  file << ";" << endl;
+  file << ";\n";
 
   /* Print sequence name and sequence length */
-  for(i = 0; i < sequenNumber; i++)
-    file << "[Name: " << setw(maxLongName + 4) << left << seqsName[i] << "Len: "
-      << residNumber << "]" << endl;
-  file << endl << "MATRIX" << endl;
+  for(i = 0; i < sequenNumber; i++) {
+    file << "[Name: ";
+    writePadded(file, seqsName[i], seqsName[i].size(), maxLongName + 4);
+    file << "Len: " << residNumber << "]\n";
+  }
+  file << "\nMATRIX\n";
 
   /* Print alignment itself. Sequence name and 50 residues blocks */
   for(j = 0; j < residNumber; j += 50) {
     for(i = 0; i < sequenNumber; i++) {
-      file << setw(maxLongName + 4) << left << seqsName[i];
-      for(k = j; k < (j + 50) && k < residNumber; k += 10)
-        file << " " << sequences[i].substr(k, 10);
-      file << endl;
+      writePadded(file, seqsName[i], seqsName[i].size(), maxLongName + 4);
+      for(k = j; k < (j + 50) && k < residNumber; k += 10) {
+        file << " ";
+        writeResidues(file, sequences[i], k, 10, reverse, upperCase, lowerCase);
+      }
+      file << "\n";
     }
-    file << endl;
+    file << "\n";
   }
-  file << ";" << endl << "END;" << endl;
-
-  /* Deallocate local memory */
-  delete [] tmpMatrix;
+  file << ";\nEND;\n";
 }
 
 void alignment::alignmentMegaToFile(ostream &file) {
   /* Generate output alignment in MEGA format */
 
   int i, j, k;
-  string *tmpMatrix;
 
   /* Check whether sequences in the alignment are aligned or not.
    * Warn about it if there are not aligned. */
@@ -1758,20 +2178,11 @@ void alignment::alignmentMegaToFile(ostream &file) {
     return ;
   }
 
-  /* Allocate local memory for generating output alignment */
-  tmpMatrix = new string[sequenNumber];
-
-  /* Depending on alignment orientation: forward or reverse. Copy directly
-   * sequence information or get firstly the reversed sequences and then
-   * copy it into local memory */
-  for(i = 0; i < sequenNumber; i++)
-    tmpMatrix[i] = (!reverse) ? sequences[i] : utils::getReverse(sequences[i]);
-
   /* Compute output file datatype */
   getTypeAlignment();
 
   /* Print output alignment header */
-  file << "#MEGA" << endl << filename << endl;
+  file << "#MEGA\n" << filename << "\n";
 
   /* Print alignment datatype */
   if ((dataType == DNAType) || (dataType == DNADeg))
@@ -1783,37 +2194,27 @@ void alignment::alignmentMegaToFile(ostream &file) {
 
   /* Print number of sequences and alignment length */
   file << "NSeqs=" << sequenNumber << " Nsites=" << residNumber
-    << " indel=- CodeTable=Standard;" << endl << endl;
+    << " indel=- CodeTable=Standard;\n\n";
 
   /* Print sequences name and sequences divided into blocks of 50 residues */
   for(i = 0; i < sequenNumber; i++) {
-    file << "#" << seqsName[i] << endl;
+    file << "#" << seqsName[i] << "\n";
     for(j = 0; j < residNumber; j += 50) {
-      for(k = j; ((k < residNumber) && (k < j + 50)); k += 10)
-        file << tmpMatrix[i].substr(k, 10) << " ";
-      file << endl;
+      for(k = j; ((k < residNumber) && (k < j + 50)); k += 10) {
+        writeResidues(file, sequences[i], k, 10, reverse, upperCase, lowerCase);
+        file << " ";
+      }
+      file << "\n";
     }
-    file << endl;
+    file << "\n";
   }
-
-  /* Deallocate local memory */
-  delete [] tmpMatrix;
 }
 
 void alignment::alignmentNBRF_PirToFile(ostream &file) {
   /* Generate output alignment in NBRF/PIR format. Sequences can be unaligned */
 
   int i, j, k;
-  string alg_datatype, *tmpMatrix;
-
-  /* Allocate local memory for generating output alignment */
-  tmpMatrix = new string[sequenNumber];
-
-  /* Depending on alignment orientation: forward or reverse. Copy directly
-   * sequence information or get firstly the reversed sequences and then
-   * copy it into local memory */
-  for(i = 0; i < sequenNumber; i++)
-    tmpMatrix[i] = (!reverse) ? sequences[i] : utils::getReverse(sequences[i]);
+  string alg_datatype;
 
   /* Compute output file datatype */
   getTypeAlignment();
@@ -1828,32 +2229,212 @@ void alignment::alignmentNBRF_PirToFile(ostream &file) {
   for(i = 0; i < sequenNumber; i++) {
 
     /* Print sequence datatype and its name */
-    if((seqsInfo != NULL) && (iformat == oformat))
-      file << ">" << seqsInfo[i].substr(0, 2) << ";" << seqsName[i]
-        << endl << seqsInfo[i].substr(2) << endl;
+    if((seqsInfo != NULL) && (iformat == oformat)) {
+      file << ">";
+      writePadded(file, seqsInfo[i], 2, 0);
+      file << ";" << seqsName[i] << "\n";
+      if(seqsInfo[i].size() > 2)
+        file.write(seqsInfo[i].data() + 2, seqsInfo[i].size() - 2);
+      file << "\n";
+    }
     else
-      file << ">" << alg_datatype << ";" << seqsName[i] << endl
-        << seqsName[i] << " " << residuesNumber[i] << " bases" << endl;
+      file << ">" << alg_datatype << ";" << seqsName[i] << "\n"
+        << seqsName[i] << " " << residuesNumber[i] << " bases\n";
 
     /* Write the sequence */
     for(j = 0; j < residuesNumber[i]; j += 50) {
-      for(k = j; (k < residuesNumber[i]) && (k < (j + 50)); k += 10)
-        file << " " << tmpMatrix[i].substr(k, 10);
+      for(k = j; (k < residuesNumber[i]) && (k < (j + 50)); k += 10) {
+        file << " ";
+        writeResidues(file, sequences[i], k, 10, reverse, upperCase, lowerCase);
+      }
 
       if(k >= residuesNumber[i]) {
         if((residuesNumber[i] % 50) == 0)
-          file << endl << " ";
+          file << "\n ";
         else if((residuesNumber[i] % 10) == 0)
           file << " ";
         file << "*";
       }
-      file << endl;
+      file << "\n";
     }
-    file << endl;
+    file << "\n";
   }
+}
 
-  /* Deallocate local memory */
-  delete [] tmpMatrix;
+static int64_t binaryTableSize(const string *table, int count) {
+  /* Bytes used by a table of strings, padding included */
+  int64_t size = sizeof(int64_t) * (count + 1);
+  int i;
+
+  for(i = 0; i < count; i++)
+    size += table[i].size();
+  return size + binaryPadding(size);
+}
+
+static void writeBinaryTable(ostream &file, const string *table, int count,
+  bool reversed, bool upperCase, bool lowerCase) {
+  /* Dump a table of strings: offsets first and then the strings, which may
+   * be reversed or have its case changed while they are written */
+  int64_t offset = 0, size = sizeof(int64_t) * (count + 1);
+  int i;
+
+  file.write((const char *) &offset, sizeof(int64_t));
+  for(i = 0; i < count; i++) {
+    offset += table[i].size();
+    file.write((const char *) &offset, sizeof(int64_t));
+  }
+  for(i = 0; i < count; i++)
+    writeResidues(file, table[i], 0, table[i].size(), reversed, upperCase,
+      lowerCase);
+
+  for(size += offset, size = binaryPadding(size); size > 0; size--)
+    file.put('\0');
+}
+
+void alignment::alignmentBinaryToFile(ostream &file) {
+  /* Generate a binary alignment. Besides sequences, it keeps some data to
+   * avoid computing it when the alignment is loaded again: its datatype,
+   * gaps and indeterminations per column and, if they have been already
+   * computed, sequences identities */
+
+  binaryHeader header;
+  string title[2];
+  int32_t *gaps = NULL;
+  int64_t k, size;
+  float *values;
+  char indet;
+  int i, j;
+
+  title[0] = filename;
+  title[1] = aligInfo;
+
+  memset(&header, 0, sizeof(binaryHeader));
+  memcpy(header.magic, binaryMagic, sizeof(binaryMagic));
+  header.byteOrder = 0x01020304;
+  header.version = 1;
+  header.sequences = sequenNumber;
+  header.residues = residNumber;
+  header.dataType = getTypeAlignment();
+  header.aligned = isAligned;
+  /* Keep the original format to be used as default output one */
+  header.format = (iformat == 0) ? 8 : iformat;
+
+  /* Compute sections layout */
+  size = sizeof(binaryHeader);
+  header.names = size;
+  size += binaryTableSize(seqsName, sequenNumber);
+  header.residuesData = size;
+  size += binaryTableSize(sequences, sequenNumber);
+  header.title = size;
+  size += binaryTableSize(title, 2);
+  if(seqsInfo != NULL) {
+    header.flags |= BINARYINFO;
+    header.info = size;
+    size += binaryTableSize(seqsInfo, sequenNumber);
+  }
+  if(isAligned) {
+    header.flags |= BINARYGAPS;
+    header.gaps = size;
+    size += sizeof(int32_t) * 2 * residNumber;
+    size += binaryPadding(size);
+  }
+  if(identities != NULL) {
+    header.flags |= BINARYIDENTITY;
+    header.identities = size;
+    size += sizeof(float) * ((int64_t) sequenNumber * (sequenNumber - 1) / 2);
+    size += binaryPadding(size);
+  }
+  header.size = size;
+
+  /* Dump header and string tables */
+  file.write((const char *) &header, sizeof(binaryHeader));
+  writeBinaryTable(file, seqsName, sequenNumber, false, false, false);
+  writeBinaryTable(file, sequences, sequenNumber, reverse, upperCase,
+    lowerCase);
+  writeBinaryTable(file, title, 2, false, false, false);
+  if(seqsInfo != NULL)
+    writeBinaryTable(file, seqsInfo, sequenNumber, false, false, false);
+
+  /* Count gaps and indeterminations per column following the output
+   * orientation */
+  if(isAligned) {
+    indet = (header.dataType == AAType) ? 'X' : 'N';
+    gaps = new int32_t[2 * residNumber];
+    for(j = 0; j < 2 * residNumber; j++)
+      gaps[j] = 0;
+
+    for(i = 0; i < sequenNumber; i++)
+      for(j = 0; j < residNumber; j++) {
+        k = (!reverse) ? j : residNumber - 1 - j;
+        if(sequences[i][j] == '-')
+          gaps[k]++;
+        else if(sequences[i][j] == indet)
+          gaps[residNumber + k]++;
+      }
+
+    file.write((const char *) gaps, sizeof(int32_t) * 2 * residNumber);
+    for(k = binaryPadding(sizeof(int32_t) * 2 * residNumber); k > 0; k--)
+      file.put('\0');
+    delete [] gaps;
+  }
+
+  /* Sequences identities: only the upper triangle is stored */
+  if(identities != NULL) {
+    values = new float[sequenNumber];
+    for(i = 0; i < sequenNumber; i++) {
+      for(j = i + 1; j < sequenNumber; j++)
+        values[j] = identities -> get(i, j);
+      file.write((const char *) (values + i + 1), sizeof(float) * (sequenNumber - i - 1));
+    }
+    delete [] values;
+    k = sizeof(float) * ((int64_t) sequenNumber * (sequenNumber - 1) / 2);
+    for(k = binaryPadding(k); k > 0; k--)
+      file.put('\0');
+  }
+}
+
+char *alignment::getColumnColors(int &size) {
+  /* Color of each residue code at each column in the HTML outputs, stored
+   * column by column. A color depends on the residue and on the whole column,
+   * so it is computed once for each code present in a column, and only for
+   * the first copy of identical columns */
+
+  int i, j, uniques;
+  const unsigned char *column;
+  const int *unique, *rows;
+  const char *symbols;
+  string tmpColumn;
+  char *colors;
+  bool *present;
+
+  column = getColumnCodes();
+  symbols = getAlphabet(size);
+  unique = getUniqueColumns(uniques, rows);
+
+  colors = new char[(size_t) residNumber * size];
+  present = new bool[size];
+  tmpColumn.resize(sequenNumber);
+
+  for(i = 0; i < residNumber; i++, column += sequenNumber) {
+    if((unique != NULL) && (rows[2 * unique[i]] != i)) {
+      memcpy(colors + (size_t) i * size, colors + (size_t) rows[2 * unique[i]] * size, size);
+      continue;
+    }
+
+    for(j = 0; j < size; j++)
+      present[j] = false;
+    for(j = 0; j < sequenNumber; j++) {
+      tmpColumn[j] = symbols[column[j]];
+      present[column[j]] = true;
+    }
+
+    for(j = 0; j < size; j++)
+      colors[(size_t) i * size + j] = present[j] ?
+        utils::determineColor(symbols[j], tmpColumn) : 'w';
+  }
+
+  delete [] present;
+  return colors;
 }
 
 bool alignment::alignmentSummaryHTML(char *destFile, int residues, int seqs, \
@@ -1862,15 +2443,12 @@ bool alignment::alignmentSummaryHTML(char *destFile, int residues, int seqs, \
   /* Generate an HTML file with a visual summary about which sequences/columns
    * have been selected and which have not */
 
-  int i, j, k, kj, upper, minHTML, maxLongName, *gapsValues;
-  string tmpColumn;
+  int i, j, k, size, upper, minHTML, maxLongName, *gapsValues;
+  const unsigned char *columns;
   float *simValues;
   bool *res, *seq;
-  ofstream file;
-  char type;
-
-  /* Allocate some local memory */
-  tmpColumn.reserve(sequenNumber);
+  outputFile file;
+  char type, *colors;
 
   /* Check whether sequences in the alignment are aligned or not.
    * Warn about it if there are not aligned. */
@@ -1879,11 +2457,14 @@ bool alignment::alignmentSummaryHTML(char *destFile, int residues, int seqs, \
     return false;
   }
 
-  /* Open output file and check that file pointer is valid */
-  file.open(destFile);
-  if(!file)
+  /* Open output file, compressed depending on its extension, and check that
+   * it is valid */
+  if(!file.open(destFile))
     return false;
 
+  columns = getColumnCodes();
+  colors = getColumnColors(size);
+
   /* Compute maximum sequences name length. */
   maxLongName = 0;
   for(i = 0; i < sequenNumber; i++)
@@ -2012,10 +2593,8 @@ bool alignment::alignmentSummaryHTML(char *destFile, int residues, int seqs, \
 
       /* Print residues corresponding to current sequences block */
       for(k = j; ((k < residNumber) && (k < upper)); k++) {
-        for(kj = 0, tmpColumn.clear(); kj < sequenNumber; kj++)
-          tmpColumn += sequences[kj][k];
-        /* Determine residue color based on residues across the alig column */
-        type = utils::determineColor(sequences[i][k], tmpColumn);
+        /* Residue color is based on residues across the alig column */
+        type = colors[(size_t) k * size + columns[(size_t) k * sequenNumber + i]];
         if (type == 'w')
           file << sequences[i][k];
         else
@@ -2124,22 +2703,19 @@ bool alignment::alignmentSummaryHTML(char *destFile, int residues, int seqs, \
   /* Print HTML footer into output file */
   file << "    </pre>" << endl << "  </body>" << endl << "</html>" << endl;
 
-  /* Close output file and deallocate local memory */
-  file.close();
+  /* Deallocate local memory and close output file */
   delete [] seq;
   delete [] res;
+  delete [] colors;
 
-  return true;
+  return file.close();
 }
 
 bool alignment::alignmentColourHTML(ostream &file) {
 
-  int i, j, kj, upper, k = 0, maxLongName = 0;
-  string tmpColumn;
-  char type;
-
-  /* Allocate some local memory */
-  tmpColumn.reserve(sequenNumber);
+  int i, j, size, upper, k = 0, maxLongName = 0;
+  const unsigned char *columns;
+  char type, *colors;
 
   /* Check whether sequences in the alignment are aligned or not.
    * Warn about it if there are not aligned. */
@@ -2147,6 +2723,8 @@ bool alignment::alignmentColourHTML(ostream &file) {
     cerr << endl << "ERROR: Sequences are not aligned." << endl << endl;
     return false;
   }
+  columns = getColumnCodes();
+  colors = getColumnColors(size);
 
   /* Compute maximum sequences name length */
   maxLongName = 0;
@@ -2193,10 +2771,8 @@ bool alignment::alignmentColourHTML(ostream &file) {
 
       /* Print residues corresponding to current sequences block */
       for(k = j; ((k < residNumber) && (k < upper)); k++) {
-        for(kj = 0, tmpColumn.clear(); kj < sequenNumber; kj++)
-          tmpColumn += sequences[kj][k];
-        /* Determine residue color based on residues across the alig column */
-        type = utils::determineColor(sequences[i][k], tmpColumn);
+        /* Residue color is based on residues across the alig column */
+        type = colors[(size_t) k * size + columns[(size_t) k * sequenNumber + i]];
         if (type == 'w')
           file << sequences[i][k];
         else
@@ -2209,6 +2785,7 @@ bool alignment::alignmentColourHTML(ostream &file) {
   /* Print HTML footer into output file */
   file << "    </pre>" << endl << "  </body>" << endl << "</html>" << endl;
 
+  delete [] colors;
   return true;
 }
 
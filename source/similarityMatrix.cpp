@@ -45,51 +45,126 @@
 
 using namespace std;
 
-extern char listSym[21];
-extern float defaultMatrix[20][20];
+/* Similarity values are stored row by row using DISTANCETABLE positions per
+ * row. Distances use one more row and column, the first ones, for unknown
+ * symbols. Symbols are mapped, in both cases, to its row in the distances */
+struct similarityTables {
+  int positions;
+  float similarity[DISTANCETABLE * DISTANCETABLE];
+  float distances[DISTANCETABLE * DISTANCETABLE];
+  unsigned char symbols[256];
+};
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+| float squareRoot(float)                                               |
+|      Square root rounded to the nearest float, as the one from the    |
+|      math library, that can be evaluated when compiling. Newton's     |
+|      method gives the root within a few double units, which is moved  |
+|      then to the nearest float comparing the squares of the midpoints |
+|      between floats, that are exact as doubles.                       |
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+static constexpr float squareRoot(float value) {
+  double root = 0, previous = 0, power = 1, unit = 0, midpoint = 0;
+  float result = 0;
+
+  if(value <= 0)
+    return 0;
+
+  /* Starting over the root, iterations decrease until reaching it */
+  root = (value > 1) ? value : 1;
+  do {
+    previous = root;
+    root = 0.5 * (root + value / root);
+  } while(root < previous);
+  result = (float) previous;
+
+  /* Distance between the result and its next float */
+  while(power > result)
+    power /= 2;
+  while(power * 2 <= result)
+    power *= 2;
+  unit = power / 8388608.0;
+
+  midpoint = result + unit / 2;
+  if(midpoint * midpoint < value)
+    return (float) (result + unit);
+
+  /* Floats below a power of two are closer */
+  if(result == power)
+    unit /= 2;
+  midpoint = result - unit / 2;
+  if(midpoint * midpoint > value)
+    return (float) (result - unit);
+
+  return result;
+}
 
-/*+++++++++++++++++++++++++++++++++++++++++++++
-| similarityMatrix::similarityMatrix()        |
-|      Class constructor.                     |
-+++++++++++++++++++++++++++++++++++++++++++++*/
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+| similarityTables buildTables(const char *, const float [][], int)     |
+|      This function builds the tables for the given symbols and        |
+|      similarity values. Distances between symbols are the Euclidean   |
+|      distances between their similarity rows. It is used for built-in |
+|      matrices when compiling and for matrices loaded from files.      |
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+template <int N>
+static constexpr similarityTables buildTables(const char *symbols, const float (&values)[N][N], int positions) {
+  similarityTables tables = {};
+  int i = 0, j = 0, k = 0;
+  float sum = 0;
+
+  tables.positions = positions;
+  for(i = 0; i < positions; i++)
+    for(j = 0; j < positions; j++)
+      tables.similarity[i * DISTANCETABLE + j] = values[i][j];
+
+  /* Calculate the distances between symbols based on Euclidean distance */
+  for(j = 0; j < positions; j++) {
+    for(i = j + 1; i < positions; i++) {
+      for(k = 0, sum = 0; k < positions; k++)
+        sum += ((values[k][j] - values[k][i]) * (values[k][j] - values[k][i]));
+      sum = squareRoot(sum);
+      tables.distances[(i + 1) * DISTANCETABLE + j + 1] = sum;
+      tables.distances[(j + 1) * DISTANCETABLE + i + 1] = sum;
+    }
+  }
 
-similarityMatrix::similarityMatrix(){
-  numPositions = 0;
-  vhash        = NULL;
-  simMat       = NULL;
-  distMat      = NULL;
-}
+  /* Unknown symbols are at any distance */
+  for(i = 0; i < DISTANCETABLE; i++) {
+    tables.distances[i] = -1;
+    tables.distances[i * DISTANCETABLE] = -1;
+  }
 
+  /* Symbols are upper case letters, they are looked up in both cases */
+  for(i = 0; i < positions; i++) {
+    tables.symbols[(unsigned char) symbols[i]] = i + 1;
+    tables.symbols[(unsigned char) (symbols[i] - 'A' + 'a')] = i + 1;
+  }
+  return tables;
+}
 
-/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-| void similarityMatrix::memoryAllocation(int)                 |
-|      This method allocates memory for some class attributes  |
-|      with a number of positios given as the method parameter |
-++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* Built-in matrices */
+static constexpr similarityTables emptyTables = buildTables(listNTSym, defaultNTMatrix, 0);
 
-void similarityMatrix::memoryAllocation(int nPos){
-  int i, j;
+static constexpr similarityTables defaultAATables = buildTables(listAASym, defaultAAMatrix, 20);
 
-  /* Initializate square table dimension to store the distances */
-  /* and to store the similarity matrix.                        */
-  if(numPositions != 0) memoryDeletion();
-  numPositions = nPos;
+static constexpr similarityTables defaultNTTables = buildTables(listNTSym, defaultNTMatrix, 5);
 
-  /* Reserve memory for all structures */
-  vhash = new int[TAMABC];
+static constexpr similarityTables defaultNTDegeneratedTables = buildTables(listNTDegenerateSym,
+  defaultNTDegeneratedMatrix, 15);
 
-  simMat = new float *[nPos];
-  distMat = new float *[nPos];
+static constexpr similarityTables alternative_1_NTDegeneratedTables = buildTables(listNTDegenerateSym,
+  alternative_1_NTDegeneratedMatrix, 15);
 
-  for(i = 0; i < nPos; i++) {
-    simMat[i]  = new float[nPos];
-    distMat[i] = new float[nPos];
+/*+++++++++++++++++++++++++++++++++++++++++++++
+| similarityMatrix::similarityMatrix()        |
+|      Class constructor.                     |
++++++++++++++++++++++++++++++++++++++++++++++*/
 
-    for(j = 0; j < nPos; j++) {
-      distMat[i][j] = 0.0;
-      simMat[i][j] = 0.0;
-    }
-  }
+similarityMatrix::similarityMatrix(){
+  loaded = NULL;
+  useTables(&emptyTables);
 }
 
 
@@ -100,32 +175,28 @@ void similarityMatrix::memoryAllocation(int nPos){
 
 similarityMatrix::~similarityMatrix(){
 
-  if(numPositions != 0) memoryDeletion();
+  delete loaded;
 
 }
 
 
-/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-| void similarityMatrix::memoryDeletion()                 |
-|      This method deletes all previously reserved memory |
-|      for the object attributes                          |
-+++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+| void similarityMatrix::useTables(const similarityTables *)   |
+|      This method sets the tables used by the object. Tables   |
+|      loaded from a file previously are deleted               |
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
-void similarityMatrix::memoryDeletion(){
-  int i;
+void similarityMatrix::useTables(const similarityTables *newTables){
 
-  for(i = 0; i < numPositions; i++){
-    delete[] simMat[i]; delete[] distMat[i];
+  if(newTables != loaded) {
+    delete loaded;
+    loaded = NULL;
   }
 
-  delete[] simMat;
-  delete[] distMat;
-  delete[] vhash;
-
-  numPositions = 0;
-  vhash        = NULL;
-  simMat       = NULL;
-  distMat      = NULL;
+  tables = newTables;
+  numPositions = tables -> positions;
+  symbolIndex = tables -> symbols;
+  distTable = tables -> distances;
 }
 
 
@@ -139,7 +210,11 @@ void similarityMatrix::memoryDeletion(){
 
 bool similarityMatrix::loadSimMatrix(char *fn){
   char aux[LINE_LENGTH+1], first[LINE_LENGTH], listSym[LINE_LENGTH+1];
-  int i,j, k; float sum; bool firstColumn = true; ifstream file;
+  int i,j, vhash[TAMABC]; bool firstColumn = true; ifstream file;
+  float values[DISTANCETABLE][DISTANCETABLE];
+
+  /* Previous matrix is not used anymore */
+  useTables(&emptyTables);
 
   /* We try to open the file, if we can't open the file */
   /* we return false.                                   */
@@ -147,13 +222,16 @@ bool similarityMatrix::loadSimMatrix(char *fn){
   if(file.fail()) return false;
 
   /* Read the first line of the file and, depending on the   */
-  /* line length (free of spaces an tabulators), we allocate */
-  /* memory for the object structures                        */
+  /* line length (free of spaces an tabulators), we get the  */
+  /* number of symbols. Each one appears only once, so there */
+  /* can not be more symbols than letters                    */
   file.getline(aux, LINE_LENGTH);
   utils::removeSpaces(aux, listSym);
-  memoryAllocation(strlen(listSym));
+  numPositions = strlen(listSym);
+  if(numPositions >= DISTANCETABLE) return false;
 
   for(i = 0; i < TAMABC; i++) vhash[i] = -1;
+  memset(values, 0, sizeof(values));
 
   /* We create the hashing vector */
   for(i = 0; i < numPositions; i++) {
@@ -161,12 +239,12 @@ bool similarityMatrix::loadSimMatrix(char *fn){
 
     if((listSym[i] >= 'A') && (listSym[i] <= 'Z')) {
       if((vhash[listSym[i] - 'A']) != -1) {
-	memoryDeletion(); return false;
+	return false;
       }
       vhash[listSym[i] - 'A'] = i;
 
     } else {
-      memoryDeletion(); return false;
+      return false;
     }
   }
 
@@ -180,7 +258,7 @@ bool similarityMatrix::loadSimMatrix(char *fn){
 
       /* Format checking. The first token must be a valid number */
       if(((first[0] >= '0' && first[0] <= '9') || (first[0] == '-' && (first[1] >= '0' && first[1] <= '9'))) && i > 0) {
-        memoryDeletion(); return false;
+        return false;
       }
 
       /* If in the token is a character, there is "first column" */
@@ -189,7 +267,7 @@ bool similarityMatrix::loadSimMatrix(char *fn){
 	firstColumn = true;
 
 	if((vhash[first[0] - 'A']) == -1){
-	  memoryDeletion(); return false;
+	  return false;
 	}
       }
 
@@ -198,7 +276,7 @@ bool similarityMatrix::loadSimMatrix(char *fn){
       else if((first[0] >= '0' && first[0] <= '9') || (first[0] == '-' && (first[1] >= '0' && first[1] <= '9'))){
 	firstColumn = false; j = 1;
 
-	simMat[i][0] = atof(first);
+	values[i][0] = atof(first);
 	first[0] = listSym[i];
       }
 
@@ -207,16 +285,16 @@ bool similarityMatrix::loadSimMatrix(char *fn){
 
       /* Do some checkings */
       if((first[0] >= 'A') && (first[0] <= 'Z') && (i > 0)) {
-        memoryDeletion(); return false;
+        return false;
       }
 
-      simMat[i][0] = atof(first);
+      values[i][0] = atof(first);
       first[0] = listSym[i];
     }
 
     /* Read the corresponding number row */
     for(; j < numPositions; j++)
-      file >> simMat[vhash[first[0] - 'A']][j];
+      file >> values[vhash[first[0] - 'A']][j];
   }
 
   /* Calculate the average between two simmetric positions            */
@@ -226,188 +304,54 @@ bool similarityMatrix::loadSimMatrix(char *fn){
 
   for(i = 0; i < numPositions; i++) {
     for(j = i+1; j < numPositions; j++) {
-      if(simMat[i][j] != simMat[j][i]) {
-        float value = (simMat[i][j] + simMat[j][i]) / 2.0;
-        simMat[i][j] = value;
-        simMat[j][i] = value;
+      if(values[i][j] != values[j][i]) {
+        float value = (values[i][j] + values[j][i]) / 2.0;
+        values[i][j] = value;
+        values[j][i] = value;
       }
     }
   }
 
   /* Calculate the distances between aminoacids */
   /* based on Euclidean distance                */
-
-  for(j = 0; j < numPositions; j++){
-    for(i = 0; i < numPositions; i++) {
-      if((i != j) && (distMat[i][j] == 0.0)){
-        for(k = 0, sum = 0; k < numPositions; k++)
-          sum += ((simMat[k][j] - simMat[k][i]) * (simMat[k][j] - simMat[k][i]));
-        sum = (float) sqrt(sum);
-        distMat[i][j] = sum;
-        distMat[j][i] = sum;
-      }
-    }
-  }
+  loaded = new similarityTables;
+  *loaded = buildTables(listSym, values, numPositions);
+  useTables(loaded);
 
   file.close();
   return true;
 }
 
-void similarityMatrix::defaultAASimMatrix(void) {
-
-  int i,j, k;
-  float sum;
-
-  memoryAllocation(20);
-  for(i = 0; i < TAMABC; i++)
-    vhash[i] = -1;
-
-  /* We create the hashing vector */
-  for(i = 0; i < numPositions; i++)
-    vhash[listAASym[i] - 'A'] = i;
-
-  for(i = 0; i < numPositions; i++)
-    for(j = 0; j < numPositions; j++)
-      simMat[i][j] = defaultAAMatrix[i][j];
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+| Built-in matrices                                                  |
+|      Their similarity values and distances have been computed when |
+|      compiling, so they are just selected                          |
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
-  /* Calculate the distances between aminoacids */
-  /* based on Euclidean distance                */
-  for(j = 0; j < numPositions; j++) {
-    for(i = 0; i < numPositions; i++) {
-      if((i != j) && (distMat[i][j] == 0.0)) {
-        for(k = 0, sum = 0; k < numPositions; k++)
-          sum += ((simMat[k][j] - simMat[k][i]) * (simMat[k][j] - simMat[k][i]));
-        sum = (float) sqrt(sum);
-        distMat[i][j] = sum;
-        distMat[j][i] = sum;
-      }
-    }
-  }
+void similarityMatrix::defaultAASimMatrix(void) {
+  useTables(&defaultAATables);
 }
 
 void similarityMatrix::defaultNTSimMatrix(void) {
-  int i,j, k;
-  float sum;
-
-  memoryAllocation(5);
-  for(i = 0; i < TAMABC; i++)
-    vhash[i] = -1;
-
-  /* We create the hashing vector */
-  for(i = 0; i < numPositions; i++)
-    vhash[listNTSym[i] - 'A'] = i;
-
-  for(i = 0; i < numPositions; i++)
-    for(j = 0; j < numPositions; j++)
-      simMat[i][j] = defaultNTMatrix[i][j];
-
-  /* Calculate the distances between aminoacids */
-  /* based on Euclidean distance                */
-  for(j = 0; j < numPositions; j++) {
-    for(i = 0; i < numPositions; i++) {
-      if((i != j) && (distMat[i][j] == 0.0)) {
-        for(k = 0, sum = 0; k < numPositions; k++)
-          sum += ((simMat[k][j] - simMat[k][i]) * (simMat[k][j] - simMat[k][i]));
-        sum = (float) sqrt(sum);
-        distMat[i][j] = sum;
-        distMat[j][i] = sum;
-      }
-    }
-  }
+  useTables(&defaultNTTables);
 }
 
 void similarityMatrix::defaultNTDegeneratedSimMatrix(void) {
-  int i, j, k;
-  float sum;
-
-  memoryAllocation(15);
-  for(i = 0; i < TAMABC; i++)
-    vhash[i] = -1;
-
-  /* We create the hashing vector */
-  for(i = 0; i < numPositions; i++)
-    vhash[listNTDegenerateSym[i] - 'A'] = i;
-
-  for(i = 0; i < numPositions; i++)
-    for(j = 0; j < numPositions; j++)
-      simMat[i][j] = defaultNTDegeneratedMatrix[i][j];
-
-  /* Calculate the distances between nucleotides based on Euclidean distance */
-  for(j = 0; j < numPositions; j++) {
-    for(i = 0; i < numPositions; i++) {
-      if((i != j) && (distMat[i][j] == 0.0)) {
-        for(k = 0, sum = 0; k < numPositions; k++)
-          sum += ((simMat[k][j] - simMat[k][i]) * (simMat[k][j] - simMat[k][i]));
-        sum = (float) sqrt(sum);
-        distMat[i][j] = sum;
-        distMat[j][i] = sum;
-      }
-    }
-  }
+  useTables(&defaultNTDegeneratedTables);
 }
 
 void similarityMatrix::alternativeSimilarityMatrices(int matrix_code, \
   int datatype) {
-  int i, j, k;
-  float sum;
 
-  /* Allocate memory depending on the input datatype */
-  switch(datatype) {
-    case AAType:
-      memoryAllocation(20);
-      break;
-    case DNAType:
-    case RNAType:
-       memoryAllocation(5);
+  /* The only alternative matrix is defined for degenerated nucleotides.
+   * Among canonical nucleotides, it is the same as the default matrix */
+  switch(matrix_code) {
+    case 1:
+      useTables(&alternative_1_NTDegeneratedTables);
       break;
-    case DNADeg:
-    case RNADeg:
-      memoryAllocation(15);
+    default:
+      useTables(&emptyTables);
       break;
- }
-
-  for(i = 0; i < TAMABC; i++)
-    vhash[i] = -1;
-
-  /* We create the hashing vector taking into account the input datatype */
-  for(i = 0; i < numPositions; i++) {
-    switch(datatype) {
-      case AAType:
-        vhash[listAASym[i] - 'A'] = i;
-        break;
-      case DNAType:
-      case RNAType:
-        vhash[listNTSym[i] - 'A'] = i;
-        break;
-      case DNADeg:
-      case RNADeg:
-        vhash[listNTDegenerateSym[i] - 'A'] = i;
-        break;
-      }
-  }
-
-  /* Working similarity matrix is set depending on the preloaded matrices */
-  for(i = 0; i < numPositions; i++) {
-    for(j = 0; j < numPositions; j++) {
-      switch(matrix_code) {
-        case 1:
-          simMat[i][j] = alternative_1_NTDegeneratedMatrix[i][j];
-          break;
-      }
-    }
-  }
-
-  /* Calculate the distances between residues based on Euclidean distance */
-  for(j = 0; j < numPositions; j++) {
-    for(i = 0; i < numPositions; i++) {
-      if((i != j) && (distMat[i][j] == 0.0)) {
-        for(k = 0, sum = 0; k < numPositions; k++)
-          sum += ((simMat[k][j] - simMat[k][i]) * (simMat[k][j] - simMat[k][i]));
-        sum = (float) sqrt(sum);
-        distMat[i][j] = sum;
-        distMat[j][i] = sum;
-      }
-    }
   }
 }
 
@@ -420,7 +364,7 @@ void similarityMatrix::printMatrix(){
 
   for(int i = 0; i < numPositions; i++){
     for(int j = 0; j < numPositions; j++)
-      cerr << setw(8) << setprecision(4) << right << simMat[i][j];
+      cerr << setw(8) << setprecision(4) << right << tables -> similarity[i * DISTANCETABLE + j];
     cerr << endl;
   }
 }
@@ -434,30 +378,33 @@ void similarityMatrix::printMatrix(){
 |      the similarity matrix file.                                          |
 +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 float similarityMatrix::getDistance(char a, char b){
-  int numa, numb; char chA, chB;
 
-  chA = (char)toupper((int) a);
-  chB = (char)toupper((int) b);
+  /* Both symbols should be defined in the matrix */
+  if(!checkSymbol(a) || !checkSymbol(b))
+    return -1;
+
+  /* Return the distance value between a and b */
+  return lookupDistance((unsigned char) a, (unsigned char) b);
+}
 
-  /* Search the first character position */
-  if((chA >= 'A') && (chA <= 'Z')) numa = vhash[chA - 'A'];
-  else { cerr << "Error: the symbol '" << a << "' is incorrect" << endl; return -1; }
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+| bool similarityMatrix::checkSymbol(char)                                  |
+|      This method checks whether the given character is defined in the     |
+|      similarity matrix. Otherwise, it reports the error and returns false |
++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+bool similarityMatrix::checkSymbol(char a){
+  char chA;
 
-  /* Search the second character position */
-  if((chB >= 'A') && (chB <= 'Z')) numb = vhash[chB - 'A'];
-  else { cerr << "Error: the symbol '" << b << "' is incorrect" << endl; return -1; }
+  chA = (char)toupper((int) a);
 
-  /* We check if the two character postions are valid positions */
-  if(numa == -1) {
-    cerr << "Error: the symbol '" << a << "' accesing the matrix is not defined in this object" << endl;
-    return -1;
+  if((chA < 'A') || (chA > 'Z')) {
+    cerr << "Error: the symbol '" << a << "' is incorrect" << endl;
+    return false;
   }
 
-  if(numb == -1) {
-    cerr << "Error: the symbol '" << b << "' accesing the matrix is not defined in this object" << endl;
-    return -1;
+  if(symbolIndex[(unsigned char) a] == 0) {
+    cerr << "Error: the symbol '" << a << "' accesing the matrix is not defined in this object" << endl;
+    return false;
   }
-
-  /* Return the distance value between a and b */
-  return distMat[numa][numb];
+  return true;
 }
@@ -38,15 +38,23 @@
 
 #include "defines.h"
 
+/* Similarity values, distances and symbols lookup table for a matrix */
+struct similarityTables;
+
 class similarityMatrix{
-  int *vhash;
-  float **simMat;
-  float **distMat;
+  /* Tables in use. They are either built-in, computed when the program is
+   * compiled, or loaded from a file and owned by the object */
+  const similarityTables *tables;
+  similarityTables *loaded;
   int numPositions;
 
+  /* Flat distances indexed by symbol. Position 0 is kept for unknown
+   * symbols, whose distance to any other one is -1 */
+  const unsigned char *symbolIndex;
+  const float *distTable;
+
  private:
-  void memoryAllocation(int);
-  void memoryDeletion();
+  void useTables(const similarityTables *);
 
  public:
   similarityMatrix();
@@ -65,6 +73,15 @@ class similarityMatrix{
 
   float getDistance(char, char);
 
+  /* Check whether a symbol is defined in the matrix and report it otherwise */
+  bool checkSymbol(char);
+
+  /* Distance between two symbols without any check. Unknown symbols have to
+   * be reported before using checkSymbol */
+  float lookupDistance(unsigned char a, unsigned char b) const {
+    return distTable[symbolIndex[a] * DISTANCETABLE + symbolIndex[b]];
+  }
+
   void printMatrix();
 };
 #endif
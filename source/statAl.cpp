@@ -33,6 +33,7 @@
 #include "compareFiles.h"
 #include "compareFiles.h"
 #include "alignment.h"
+#include "threadPool.h"
 #include "defines.h"
 #include "utils.h"
 
@@ -42,21 +43,24 @@ void show_examples(void);
 int main(int argc, char *argv[]){
 
   /* Input values */
-  char *inFile = NULL, *forceFile = NULL, *setAlignments = NULL, *matrix = NULL;
+  char *inFile = NULL, *forceFile = NULL, *setAlignments = NULL, *matrix = NULL,
+    *outFile = NULL;
   int windowSize = -1, gapWindow = -1, simWindow = -1, conWindow = -1,
-    alternative_matrix = -1;
+    alternative_matrix = -1, threads = -1, approxCons = -1;
   bool stats_gaps_columns = 0, stats_gaps_dist = 0, stats_simil_columns = 0,
     stats_simil_dist = 0, stats_seqs_ident = 0, stats_col_ident_gen = 0,
-    stats_file_columns = 0, stats_file_dist = 0;
+    stats_file_columns = 0, stats_file_dist = 0, compactIdentity = false;
   alignment *origAlig = NULL, **compAlig  = NULL;
 
   /* Internal variables */
   int i = 1, numFiles = 0, maxResidues = 0, referFile = 0, alignDataType = -1;
   similarityMatrix *similMatrix = NULL;
   char **filesToCompare = NULL;
-  bool appearErrors = false;
+  bool appearErrors = false, written = true;
   float *compareVect = NULL;
   ifstream algsPaths;
+  outputFile statsFile;
+  streambuf *console = NULL;
   string line;
 
   /* ***** ***** ***** ***** ***** Help functions ***** ***** ***** ***** *** */
@@ -112,6 +116,12 @@ int main(int argc, char *argv[]){
       }
     }
 
+    /* Dump stats into a file instead of using the standard output */
+    else if(!strcmp(argv[i], "-out") && (i+1 != argc) && (outFile == NULL)) {
+      outFile = new char[(int) strlen(argv[++i]) + 1];
+      strcpy(outFile, argv[i]);
+    }
+
     /* Load a set of alignments to perform alignments comparisos among them */
     else if(!strcmp(argv[i], "-compareset") && (i+1 != argc) &&
       (setAlignments == NULL)) {
@@ -224,6 +234,34 @@ int main(int argc, char *argv[]){
         appearErrors = true;
       }
     }
+    /* Number of threads used for comparisons between all the sequences */
+    else if(!strcmp(argv[i], "-threads") && (i+1 != argc) && (threads == -1)) {
+      if(!utils::isNumber(argv[i+1])) {
+        cerr << endl << "ERROR: Number of threads should be a number\n\n";
+        appearErrors = true;
+      }
+      else if((threads = atoi(argv[++i])) < 1) {
+        cerr << endl << "ERROR: Number of threads should be equal or greater "
+          << "than 1. Check your command-line parameter\n\n";
+        appearErrors = true;
+      }
+    }
+    /* Store identities between sequences as fixed point values */
+    else if(!strcmp(argv[i], "-compactidentity") && (!compactIdentity))
+      compactIdentity = true;
+
+    /* Number of pairs of residues sampled to estimate similarity values */
+    else if(!strcmp(argv[i], "-approx_cons") && (i+1 != argc) && (approxCons == -1)) {
+      if(!utils::isNumber(argv[i+1])) {
+        cerr << endl << "ERROR: Number of sampled pairs should be a number\n\n";
+        appearErrors = true;
+      }
+      else if((approxCons = atoi(argv[++i])) < 2) {
+        cerr << endl << "ERROR: Number of sampled pairs should be greater "
+          << "than 1. Check your command-line parameter\n\n";
+        appearErrors = true;
+      }
+    }
 
     else {
       cerr << endl << "ERROR: Parameter \"" << argv[i] << "\" not valid\n\n.";
@@ -236,6 +274,13 @@ int main(int argc, char *argv[]){
   }
 
   /* ***** ***** ***** ** Control input parameters errors ***** ***** ***** * */
+  if((!appearErrors) && (threads != -1))
+    threadPool::setSharedThreads(threads);
+  if((!appearErrors) && (compactIdentity))
+    identityMatrix::setCompact(true);
+  if((!appearErrors) && (approxCons != -1))
+    statisticsConservation::setSamples(approxCons);
+
   if((!appearErrors) && (inFile != NULL)) {
     if((stats_file_columns) || (stats_file_dist)) {
       cerr << endl << "ERROR: No stats about alignments comparison can be "
@@ -421,6 +466,18 @@ int main(int argc, char *argv[]){
       }
     }
   }
+  /* ***** ***** ***** ***** *** Open output file ***** ***** ***** ***** *** */
+  /* Stats are written into the standard output unless an output file, which
+   * may be compressed, has been provided */
+  if((!appearErrors) && (outFile != NULL)) {
+    if(!statsFile.open(outFile)) {
+      cerr << endl << "ERROR: Impossible to generate OUTPUT file \"" << outFile
+        << "\"" << endl << endl;
+      appearErrors = true;
+    }
+    else
+      console = cout.rdbuf(statsFile.rdbuf());
+  }
   /* ***** ***** ***** ***** ** Compute/Show stats ***** ***** ***** ***** ** */
   if(!appearErrors) {
     if(stats_gaps_columns) {
@@ -458,6 +515,17 @@ int main(int argc, char *argv[]){
         compareVect);
     }
   }
+  /* ***** ***** ***** ***** *** Close output file ***** ***** ***** ***** ** */
+  if(console != NULL) {
+    /* Console stream state is reset once its buffer is restored */
+    written = !cout.bad();
+    cout.rdbuf(console);
+    if((!statsFile.close()) || (!written)) {
+      cerr << endl << "ERROR: Impossible to write OUTPUT file \"" << outFile
+        << "\"" << endl << endl;
+      appearErrors = true;
+    }
+  }
   /* ***** ***** ***** ***** *** Deallocate memory ***** ***** ***** ***** ** */
   delete origAlig;
   delete[] compAlig;
@@ -468,6 +536,7 @@ int main(int argc, char *argv[]){
   delete[] compareVect;
 
   delete[] inFile;
+  delete[] outFile;
   delete[] matrix;
   delete[] forceFile;
 
@@ -502,7 +571,13 @@ void show_menu(void) {
 
   cout << "    -i -in <inputfile>       "
     << "Input file in several formats (clustal, fasta, nexus, phylip, etc)."
-    << endl << endl;
+    << endl << "                             "
+    << "It may be compressed using gzip or zstd. Use - to read it from stdin."
+    << endl;
+  cout << "    -out <outputfile>        "
+    << "Output file for the stats (default STDOUT). Files named *.gz or "
+    << endl << "                             "
+    << "*.zst are compressed." << endl << endl;
 
   cout << "    -compareset <inputfile>     "
     << "Input list of paths for the alignments to compare." << endl;
@@ -553,6 +628,19 @@ void show_menu(void) {
   cout << "    -cw <n>                     "
     << "(half) Window size only applies to statistics based on Consistency."
     << endl << endl;
+
+  cout << "    -threads <n>                "
+    << "Number of threads used for comparisons between all the sequences "
+    << endl << "                                "
+    << "(default: number of available processors)." << endl;
+  cout << "    -compactidentity            "
+    << "Store identities between sequences as 16 bits values to reduce memory "
+    << endl << "                                "
+    << "usage. Scores might differ slightly from the default ones." << endl;
+  cout << "    -approx_cons <k>            "
+    << "Estimate similarity values from k pairs of residues per column and "
+    << endl << "                                "
+    << "print their confidence intervals." << endl << endl;
 }
 
 void show_examples(void) {
@@ -26,15 +26,18 @@
 
 #include "statisticsConservation.h"
 
+int statisticsConservation::samples = 0;
+
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-|  statisticsConservation::statisticsConservation(char **, int, int)                                                   |
+|  statisticsConservation::statisticsConservation(const identityMatrix *, int, int, int)                               |
 |                                                                                                                      |
-|       Class constructor. This method uses the inputs parameters to put the information in the new object that        |
-|       has been created.                                                                                              |
+|     Class constructor. This method uses the inputs parameters to put the information in the new object that          |
+|     has been created. Sequences identities are computed and kept by the alignment, so they are not computed again.   |
 |                                                                                                                      |
 ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
-statisticsConservation::statisticsConservation(string *alignmentMatrix, int species, int aminos, int dataType_) {
+statisticsConservation::statisticsConservation(const identityMatrix *seqIdentities, int species, int aminos,
+  int dataType_) {
 
   /* Initializate values to its corresponds values */
   columns = aminos;
@@ -43,26 +46,37 @@ statisticsConservation::statisticsConservation(string *alignmentMatrix, int spec
   halfWindow = -1;
 
   /* Allocate memory to the structures and initializates it */
-  Q = new float[columns];
-  utils::initlVect(Q, columns, 0);
-
   MDK = new float[columns];
   utils::initlVect(MDK, columns, 0);
 
   MDK_Window = new float[columns];
   utils::initlVect(MDK_Window, columns, 0);
 
-  matrixIdentity = new float*[sequences];
-  for(int i = 0; i < sequences; i++){
-    matrixIdentity[i] = new float[sequences];
-    utils::initlVect(matrixIdentity[i], sequences, 0);
-  }
+  /* Conservation values are not known until their bounds are computed. Windows values are 0 until a window is
+     applied */
+  lowerMDK = new float[columns];
+  utils::initlVect(lowerMDK, columns, 0);
+
+  upperMDK = new float[columns];
+  utils::initlVect(upperMDK, columns, 1);
+
+  lowerWindow = new float[columns];
+  utils::initlVect(lowerWindow, columns, 0);
+
+  upperWindow = new float[columns];
+  utils::initlVect(upperWindow, columns, 0);
+
+  identities = seqIdentities;
+
+  codes = NULL;
+  gaps = NULL;
+  distances = NULL;
+  alphabetSize = 0;
+  copies = NULL;
+  sameColumn = NULL;
 
   /* Initializate the similarity matrix to NULL. */
   simMatrix = NULL;
-
-  /* Calculation methods call */
-  calculateMatrixIdentity(alignmentMatrix);
 }
 
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -80,12 +94,23 @@ statisticsConservation::statisticsConservation(void) {
   halfWindow = 0;
 
   /* and the pointers to NULL */
-  Q = NULL;
   MDK = NULL;
   MDK_Window = NULL;
 
-  matrixIdentity = NULL;
+  lowerMDK = NULL;
+  upperMDK = NULL;
+  lowerWindow = NULL;
+  upperWindow = NULL;
+
+  identities = NULL;
   simMatrix = NULL;
+
+  codes = NULL;
+  gaps = NULL;
+  distances = NULL;
+  alphabetSize = 0;
+  copies = NULL;
+  sameColumn = NULL;
 }
 
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -97,130 +122,464 @@ statisticsConservation::statisticsConservation(void) {
 
 statisticsConservation::~statisticsConservation(void) {
 
-  int i;
-
   /* Deallocate memory, if it have been allocated previously. */
-  if(Q != NULL) {
-    delete[] Q;
+  if(MDK != NULL) {
     delete[] MDK;
     delete[] MDK_Window;
-
-    for(i = 0; i < sequences; i++)
-      delete[] matrixIdentity[i];
-    delete[] matrixIdentity;
+    delete[] lowerMDK;
+    delete[] upperMDK;
+    delete[] lowerWindow;
+    delete[] upperWindow;
   }
+
+  delete[] distances;
+  delete[] copies;
+  delete[] sameColumn;
 }
 
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-|  void statisticsConservation::calculateMatrixIdentity(char **, int, int)                                             |
+|  bool statisticsConservation::calculateVectors(const unsigned char *, const char *, int, int *, const int *, int,     |
+|                                                const int *, const int *)                                             |
 |                                                                                                                      |
-|       This method computes the matrix identity between all the sequences in the alignment.                           |
+|     This method computes the bounds of the conservation value for each column in the alignment. Residues codes are   |
+|     stored column by column, so each column is read as a contiguous block, and distances between codes are looked up |
+|     in a table computed once from the alphabet. Exact values, that need every pair of residues in the column, are    |
+|     only computed when they are asked for. Blocks of columns are computed in parallel by the shared thread pool.     |
+|     Identical sequences, given by their unique sequence if any, usually have a null weight. In that case, their      |
+|     pairs add nothing to the sums and they are skipped. Identical columns, given by their unique column if any, are  |
+|     computed once when they have the same gaps as well.                                                              |
 |                                                                                                                      |
 ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
-void statisticsConservation::calculateMatrixIdentity(string *alignmentMatrix) {
+bool statisticsConservation::calculateVectors(const unsigned char *alignmentMatrix, const char *alphabet,
+  int alphabetSize_, int *gaps_, const int *unique, int uniques, const int *uniqueColumns, const int *columnRows) {
 
-  char indet;
-  int i, j, k, sum, length;
+  conservationJob job;
+  int i, j, k, *first, *members;
+  bool *skipped;
 
-  /* Depending on alignment type, indetermination symbol will be one or other */
-  indet = (dataType == AAType) ? 'X' : 'N';
+  /* A conservation matrix and the sequences identities must be defined. If not, return false */
+  if((simMatrix == NULL) || (identities == NULL))
+    return false;
 
-  /* For each sequences' pair */
-  for(i = 0; i < sequences; i++) {
-    for(j = i + 1; j < sequences; j++) {
+  /* Symbols not defined in the similarity matrix are reported just once. Their distances are -1 */
+  for(j = INDETCODE + 1; j < alphabetSize_; j++)
+    simMatrix -> checkSymbol(alphabet[j]);
+
+  /* Compute the distance between each pair of valid codes */
+  alphabetSize = alphabetSize_;
+  delete [] distances;
+  distances = new float[alphabetSize * alphabetSize];
+  utils::initlVect(distances, alphabetSize * alphabetSize, 0);
+  for(j = INDETCODE + 1; j < alphabetSize; j++)
+    for(k = INDETCODE + 1; k < alphabetSize; k++)
+      distances[j * alphabetSize + k] = simMatrix -> lookupDistance(alphabet[j], alphabet[k]);
+
+  /* Residues codes and gaps are kept by the alignment as long as these statistics */
+  codes = alignmentMatrix;
+  gaps = gaps_;
+
+  /* Sort sequences by their unique sequence and check the weights between the copies of each one */
+  delete [] copies;
+  copies = NULL;
+  if(unique != NULL) {
+    first = new int[uniques + 1];
+    members = new int[sequences];
+    skipped = new bool[uniques];
+    utils::initlVect(first, uniques + 1, 0);
 
-      /* For each position in the alignment of that pair than we are processing */
-      for(k = 0, sum = 0, length = 0; k < columns; k++) {
+    for(i = 0; i < sequences; i++)
+      first[unique[i] + 1]++;
+    for(i = 0; i < uniques; i++)
+      first[i + 1] += first[i];
+    for(i = 0; i < sequences; i++)
+      members[first[unique[i]]++] = i;
+    for(i = uniques; i > 0; i--)
+      first[i] = first[i - 1];
+    first[0] = 0;
+
+    for(i = 0; i < uniques; i++) {
+      skipped[i] = true;
+      for(j = first[i]; (j < first[i + 1]) && (skipped[i]); j++)
+        for(k = j + 1; (k < first[i + 1]) && (skipped[i]); k++)
+          skipped[i] = ((float) (100.0 - identities -> get(members[j], members[k]) * 100.0) == 0);
+    }
 
-        /* If we find a element that is not a gap or an X aminoacid in the first sequence of the pair */
-        if((alignmentMatrix[i][k] != '-') && (alignmentMatrix[i][k] != indet)) {
+    copies = new int[sequences];
+    for(i = 0; i < sequences; i++)
+      copies[i] = skipped[unique[i]] ? unique[i] : -1 - i;
 
-          /* If we also find a valid element in the second sequence  */
-          if((alignmentMatrix[j][k] != '-') && (alignmentMatrix[j][k] != indet))
+    delete [] first;
+    delete [] members;
+    delete [] skipped;
+  }
 
-            /* If the two valid elements are the same increase the sum */
-            if(alignmentMatrix[j][k] ==  alignmentMatrix[i][k])
-              sum++;
+  /* Columns computed for each set of identical columns */
+  delete [] sameColumn;
+  sameColumn = NULL;
+  if(uniqueColumns != NULL) {
+    sameColumn = new int[columns];
+    for(i = 0; i < columns; i++) {
+      j = columnRows[2 * uniqueColumns[i]];
+      sameColumn[i] = ((gaps == NULL) || (gaps[i] == gaps[j])) ? j : i;
+    }
+  }
 
-          /* Increase the length of the sequence free of gaps and X elements */
-          length++;
-        }
+  job.object = this;
+  job.list = NULL;
+  job.count = columns;
+  threadPool::runShared((columns + CONSERVATIONBLOCK - 1) / CONSERVATIONBLOCK, boundsTask, &job);
+
+  if(sameColumn != NULL)
+    for(i = 0; i < columns; i++)
+      if(sameColumn[i] != i) {
+        MDK[i] = MDK[sameColumn[i]];
+        lowerMDK[i] = lowerMDK[sameColumn[i]];
+        upperMDK[i] = upperMDK[sameColumn[i]];
+      }
+
+  return true;
+}
 
-        /* If the first processed element is invalid and in the second we find a valid element increase the length of
-           the sequence free of gaps and X elements */
-        else if((alignmentMatrix[j][k] != '-') && (alignmentMatrix[j][k] != indet))
-          length++;
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+|  void statisticsConservation::boundsTask(int, void *)                                                                |
+|                                                                                                                      |
+|     This method computes the bounds of the conservation values for a block of columns. Q is an average of the        |
+|     distances between the pairs of residues in the column, weighted by non-negative values, so it is between the     |
+|     minimum and the maximum distance among the residues present. Bounds are widened to take into account rounding    |
+|     errors of the sums computing Q. Columns with 80% or more gaps, and those without pairs, get their exact value.   |
+|     When conservation values are estimated, bounds are narrowed to the confidence interval of the estimate and       |
+|     columns with no more pairs than those sampled get their exact value.                                             |
+|                                                                                                                      |
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+void statisticsConservation::boundsTask(int task, void *data) {
+
+  conservationJob *job = (conservationJob *) data;
+  statisticsConservation *stats = job -> object;
+  const unsigned char *column;
+  const float *distances = stats -> distances;
+  double minimum, maximum, error, margin, lowerQ, upperQ, pairs;
+  int i, j, k, last, residues, symbols, *counts, *present, *valid;
+  bool weighted;
+
+  counts = new int[stats -> alphabetSize];
+  present = new int[stats -> alphabetSize];
+  valid = new int[stats -> sequences];
+  last = utils::min((task + 1) * CONSERVATIONBLOCK, stats -> columns);
+
+  for(i = task * CONSERVATIONBLOCK; i < last; i++) {
+    /* Copies of a column get its bounds once they are computed */
+    if((stats -> sameColumn != NULL) && (stats -> sameColumn[i] != i))
+      continue;
+
+    /* If the column has 80% or more gaps then its conservation value is 0 */
+    if((stats -> gaps != NULL) && (((float) stats -> gaps[i] / stats -> sequences) >= 0.8)) {
+      stats -> MDK[i] = stats -> lowerMDK[i] = stats -> upperMDK[i] = 0;
+      continue;
+    }
+
+    /* Count the residues of each symbol in the column and gather the sequences with a valid residue */
+    column = stats -> codes + (size_t) i * stats -> sequences;
+    utils::initlVect(counts, stats -> alphabetSize, 0);
+    for(j = 0, residues = 0; j < stats -> sequences; j++)
+      if(column[j] > INDETCODE) {
+        counts[column[j]]++;
+        valid[residues++] = j;
       }
 
-      /* Calculate the value of matrixidn for columns j and i */
-      matrixIdentity[j][i] = (100.0 - ((float) sum/ length) * 100.0);
-      matrixIdentity[i][j] = matrixIdentity[j][i];
+    /* Without pairs, Q is 0 and the conservation value is 1 */
+    if(residues < 2) {
+      stats -> MDK[i] = stats -> lowerMDK[i] = stats -> upperMDK[i] = 1;
+      continue;
+    }
+
+    /* Columns with no more pairs than those sampled are not estimated */
+    pairs = (double) residues * (residues - 1) / 2;
+    if((samples > 0) && (pairs <= samples)) {
+      stats -> MDK[i] = stats -> lowerMDK[i] = stats -> upperMDK[i] = stats -> columnValue(column, valid, residues);
+      continue;
+    }
+
+    /* Rounding errors grow with the number of pairs. For huge columns, bounds are not useful */
+    error = (pairs + 1) * FLT_EPSILON / 2;
+    if(error >= 0.25) {
+      stats -> lowerMDK[i] = 0;
+      stats -> upperMDK[i] = 1;
+    }
+
+    else {
+      /* Minimum and maximum distances between pairs of residues in the column. Distances are symmetric */
+      for(j = INDETCODE + 1, symbols = 0; j < stats -> alphabetSize; j++)
+        if(counts[j] != 0)
+          present[symbols++] = j;
+
+      minimum = maximum = distances[present[0] * stats -> alphabetSize + present[(counts[present[0]] > 1) ? 0 : 1]];
+      for(j = 0; j < symbols; j++)
+        for(k = (counts[present[j]] > 1) ? j : j + 1; k < symbols; k++) {
+          minimum = utils::min(minimum, (double) distances[present[j] * stats -> alphabetSize + present[k]]);
+          maximum = utils::max(maximum, (double) distances[present[j] * stats -> alphabetSize + present[k]]);
+        }
+
+      /* Relative errors of the numerator and the denominator are below error / (1 - error), plus the division */
+      error = error / (1 - error);
+      margin = utils::max(fabs(minimum), fabs(maximum)) * (2 * error / (1 - error) + FLT_EPSILON);
+      lowerQ = minimum - margin;
+      upperQ = maximum + margin;
+
+      /* Q is 0 when every pair weight is 0. It is only relevant if Q should be positive otherwise */
+      weighted = (lowerQ <= 0);
+      for(j = 0; (j < residues) && (!weighted); j++)
+        for(k = j + 1; (k < residues) && (!weighted); k++)
+          weighted = ((float) (100.0 - stats -> identities -> get(valid[j], valid[k]) * 100.0) > 0);
+
+      /* MDK decreases as Q increases and it is normalized to 1 */
+      stats -> lowerMDK[i] = utils::min((float) exp(-(float) upperQ), (float) 1);
+      stats -> upperMDK[i] = weighted ? utils::min((float) exp(-(float) lowerQ), (float) 1) : 1;
     }
+
+    /* Values not known yet are set to their lower bounds, unless they are estimated */
+    stats -> MDK[i] = stats -> lowerMDK[i];
+    if(samples > 0)
+      stats -> estimateColumn(i, column, valid, residues);
   }
+
+  delete [] counts;
+  delete [] present;
+  delete [] valid;
 }
 
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-|  bool statisticsConservation::calculateVectors(char **, int *)                                                       |
+|  void statisticsConservation::conservationTask(int, void *)                                                          |
 |                                                                                                                      |
-|       This method computes the distance between pairs for each column in the alignment.                              |
+|     This method computes the Q and MDK values for a block of the listed columns. Sequences with a valid residue are  |
+|     gathered first for each column, so pairs are only visited between them.                                          |
 |                                                                                                                      |
 ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
-bool statisticsConservation::calculateVectors(string *alignmentMatrix, int *gaps) {
+void statisticsConservation::conservationTask(int task, void *data) {
 
-  char indet;
-  int i, j, k;
-  float num, den;
+  conservationJob *job = (conservationJob *) data;
+  statisticsConservation *stats = job -> object;
+  const unsigned char *column;
+  int i, j, n, last, residues, *valid;
 
-  /* Depending on alignment type, indetermination symbol will be one or other */
-  indet = (dataType == AAType) ? 'X' : 'N';
+  valid = new int[stats -> sequences];
+  last = utils::min((task + 1) * CONSERVATIONBLOCK, job -> count);
 
-  /* A conservation matrix must be defined. If not, return false */
-  if(simMatrix == NULL)
-    return false;
+  for(n = task * CONSERVATIONBLOCK; n < last; n++) {
+    i = job -> list[n];
 
-  /* For each column calculate the Q value and the MD value using an equation */
-  for(i = 0; i < columns; i++) {
-    /* For each AAs/Nucleotides' pair in the column we compute its distance */
-    for(j = 0, num = 0, den = 0; j < sequences; j++) {
-      /* We don't compute the distant if the first element is a indeterminate (X) or a gap (-) element. */
-      if((alignmentMatrix[j][i] != '-') && (alignmentMatrix[j][i] != indet))
-        for(k = j + 1; k < sequences; k++)
-          /* We don't compute the distant between the pair if the second element is a indeterminate or a gap element */
-          if((alignmentMatrix[k][i] != '-') && (alignmentMatrix[k][i] != indet)) {
-            /* We use the identity value for the two pairs and its distance based on similarity matrix's value. */
-            num += matrixIdentity[j][k] * simMatrix -> getDistance(alignmentMatrix[j][i], alignmentMatrix[k][i]);;
-            den += matrixIdentity[j][k];
-          }
+    /* We don't compute the distance for indeterminate (X) or gap (-) elements */
+    column = stats -> codes + (size_t) i * stats -> sequences;
+    for(j = 0, residues = 0; j < stats -> sequences; j++)
+      if(column[j] > INDETCODE)
+        valid[residues++] = j;
+
+    stats -> MDK[i] = stats -> lowerMDK[i] = stats -> upperMDK[i] = stats -> columnValue(column, valid, residues);
+  }
+
+  delete [] valid;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+|  float statisticsConservation::columnValue(const unsigned char *, const int *, int)                                  |
+|                                                                                                                      |
+|     This method computes the Q and MDK values for a column from the sequences with a valid residue on it. Every pair |
+|     of those sequences is visited, but those of copies of the same sequence with a null weight.                      |
+|                                                                                                                      |
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+float statisticsConservation::columnValue(const unsigned char *column, const int *valid, int residues) {
+
+  const float *row;
+  const int *copy = copies;
+  float num, den, weight, Q, value;
+  int j, k, group;
+
+  /* For each AAs/Nucleotides' pair in the column we compute its distance */
+  for(j = 0, num = 0, den = 0; j < residues; j++) {
+    row = distances + column[valid[j]] * alphabetSize;
+    group = (copy != NULL) ? copy[valid[j]] : 0;
+    for(k = j + 1; k < residues; k++) {
+      /* Pairs of copies of the same sequence, with a null weight, are skipped */
+      if((copy != NULL) && (copy[valid[k]] == group))
+        continue;
+
+      /* We use the identity value for the two pairs and its distance based on similarity matrix's value. */
+      weight = (float) (100.0 - identities -> get(valid[j], valid[k]) * 100.0);
+      num += weight * row[column[valid[k]]];
+      den += weight;
     }
-    /* If we are procesing a column with only one AA/nucleotide, the denominator is 0 and we don't execute the division
-       and we set the Q[i] value to 0. */
-    Q[i] = (den == 0) ? 0 : num / den;
-    MDK[i] = (float) exp(-Q[i]);
+  }
 
-    /* If the column has 80% or more gaps then we set its conservation value to 0 */
-    if(gaps != NULL)
-      if(((float) gaps[i] / sequences) >= 0.8) MDK[i] = 0;
+  /* If we are procesing a column with only one AA/nucleotide, the denominator is 0 and we don't execute the division
+     and we set the Q value to 0. */
+  Q = (den == 0) ? 0 : num / den;
+  value = (float) exp(-Q);
 
-    /* If the MDK value is more than 1, we normalized this value to 1. */
-    if(MDK[i] > 1) MDK[i] = 1;
+  /* If the MDK value is more than 1, we normalized this value to 1. */
+  return (value > 1) ? 1 : value;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+|  void statisticsConservation::estimateColumn(int, const unsigned char *, const int *, int)                           |
+|                                                                                                                      |
+|     This method estimates Q for a column as the weighted average of the distances of a sample of its pairs. Pairs    |
+|     are sorted by their first sequence and taken at regular intervals, so every sequence is represented in the       |
+|     sample in proportion to its pairs. The variance of this ratio estimator, corrected for the finite number of      |
+|     pairs, gives a confidence interval for Q. Column bounds are narrowed to that interval and the column value is    |
+|     set to the estimate. Samples without weighted pairs keep the column bounds.                                      |
+|                                                                                                                      |
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+void statisticsConservation::estimateColumn(int i, const unsigned char *column, const int *valid, int residues) {
+
+  double pairs, position, num, den, squares, products, weights, variance, deviation, Q;
+  float weight, distance, lower, upper;
+  int s, j, k;
+
+  pairs = (double) residues * (residues - 1) / 2;
+  num = 0; den = 0; squares = 0; products = 0; weights = 0;
+
+  for(s = 0; s < samples; s++) {
+    /* Sequences j < k of the pair at the center of each interval of pairs */
+    position = floor((s + 0.5) * pairs / samples);
+    j = residues - 2 - (int) floor(sqrt(4 * (double) residues * (residues - 1) - 8 * position - 7) / 2 - 0.5);
+    k = (int) (position + j + 1 - pairs + (double) (residues - j) * (residues - j - 1) / 2);
+
+    weight = (float) (100.0 - identities -> get(valid[j], valid[k]) * 100.0);
+    distance = distances[column[valid[j]] * alphabetSize + column[valid[k]]];
+
+    num += (double) weight * distance;
+    den += weight;
+    squares += (double) weight * weight * distance * distance;
+    products += (double) weight * weight * distance;
+    weights += (double) weight * weight;
   }
 
-  return true;
+  if(den == 0)
+    return;
+
+  Q = num / den;
+  variance = (squares - 2 * Q * products + Q * Q * weights) / (den * den) * samples / (samples - 1) * (1 - samples / pairs);
+  deviation = CONFIDENCEZ * sqrt(utils::max(variance, 0.0));
+
+  /* MDK decreases as Q increases and it is normalized to 1 */
+  lower = utils::max(lowerMDK[i], utils::min((float) exp(-(Q + deviation)), (float) 1));
+  upper = utils::min(upperMDK[i], utils::min((float) exp(-(Q - deviation)), (float) 1));
+  if(lower > upper)
+    return;
+
+  lowerMDK[i] = lower;
+  upperMDK[i] = upper;
+  MDK[i] = utils::max(lower, utils::min(utils::min((float) exp(-Q), (float) 1), upper));
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+|  float statisticsConservation::windowValue(const float *, int)                                                       |
+|                                                                                                                      |
+|     This method computes the average of the given values over the window centered on a column. Positions out of the  |
+|     alignment are mirrored from its ends.                                                                            |
+|                                                                                                                      |
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+float statisticsConservation::windowValue(const float *values, int column) {
+
+  float value = 0;
+  int j;
+
+  for(j = column - halfWindow; j <= column + halfWindow; j++) {
+    if(j < 0) value += values[-j];
+    else if(j >= columns) value += values[((2 * columns - j) - 2)];
+    else value += values[j];
+  }
+
+  /* Calculate the similiraty value for the column */
+  return value / (float) (2 * halfWindow + 1);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+|  void statisticsConservation::computeWindows(const int *, int)                                                       |
+|                                                                                                                      |
+|     This method computes the exact conservation value of the given windows. Columns inside those windows whose       |
+|     values are not known yet are computed in parallel.                                                               |
+|                                                                                                                      |
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+void statisticsConservation::computeWindows(const int *windows, int count) {
+
+  conservationJob job;
+  int i, j, k, *list;
+  bool *listed;
+
+  list = new int[columns];
+  listed = new bool[columns];
+  for(i = 0; i < columns; i++)
+    listed[i] = false;
+
+  /* Columns, mirrored at the alignment ends, needed by each window. Only the first copy of identical columns is
+     computed */
+  for(i = 0, job.count = 0; i < count; i++)
+    for(j = windows[i] - halfWindow; j <= windows[i] + halfWindow; j++) {
+      k = (j < 0) ? -j : ((j >= columns) ? ((2 * columns - j) - 2) : j);
+      k = (sameColumn != NULL) ? sameColumn[k] : k;
+      if((lowerMDK[k] != upperMDK[k]) && (!listed[k])) {
+        listed[k] = true;
+        list[job.count++] = k;
+      }
+    }
+
+  job.object = this;
+  job.list = list;
+  if(job.count > 0)
+    threadPool::runShared((job.count + CONSERVATIONBLOCK - 1) / CONSERVATIONBLOCK, conservationTask, &job);
+
+  /* Copies of the computed columns get their values */
+  if((sameColumn != NULL) && (job.count > 0))
+    for(i = 0; i < columns; i++)
+      if((lowerMDK[i] != upperMDK[i]) && (listed[sameColumn[i]]))
+        MDK[i] = lowerMDK[i] = upperMDK[i] = MDK[sameColumn[i]];
+
+  for(i = 0; i < count; i++)
+    MDK_Window[windows[i]] = lowerWindow[windows[i]] = upperWindow[windows[i]] = windowValue(MDK, windows[i]);
+
+  delete [] list;
+  delete [] listed;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+|  void statisticsConservation::computeWindows(float, float)                                                           |
+|                                                                                                                      |
+|     This method computes the exact conservation value of those windows whose bounds overlap the given range.         |
+|                                                                                                                      |
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+void statisticsConservation::computeWindows(float lower, float upper) {
+
+  int i, count, *windows;
+
+  windows = new int[columns];
+  for(i = 0, count = 0; i < columns; i++)
+    if((lowerWindow[i] != upperWindow[i]) && (lowerWindow[i] <= upper) && (upperWindow[i] >= lower))
+      windows[count++] = i;
+
+  computeWindows(windows, count);
+  delete [] windows;
 }
 
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 |  bool statisticsConservation::applyWindow(int)                                                                       |
 |                                                                                                                      |
-|       This method computes for each column's alignment its conservationwindows' value. For this purpose, the method  |
-|       uses the values that previously has been calculated and the window's size value.                               |
+|     This method computes for each column's alignment the bounds of its conservation windows' value. For this         |
+|     purpose, the method uses the bounds that previously has been calculated and the window's size value. Sums        |
+|     are done in the same order for the bounds and the values, so windows values are kept within their bounds.        |
 |                                                                                                                      |
 ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 bool statisticsConservation::applyWindow(int _halfWindow) {
 
-  int i, j, window;
+  int i;
 
   /* If one of this conditions is true, we return FALSE:                         */
   /*    .- If already exists a previously calculated vector for this window size */
@@ -229,18 +588,12 @@ bool statisticsConservation::applyWindow(int _halfWindow) {
      return false;
 
   halfWindow = _halfWindow;
-  window = 2 * halfWindow + 1;
 
   /* Do the average window calculations */
   for(i = 0; i < columns; i++) {
-    for(j = i - halfWindow; j <= i + halfWindow; j++) {
-      if(j < 0) MDK_Window[i] += MDK[-j];
-      else if(j >= columns) MDK_Window[i] += MDK[((2 * columns - j) - 2)];
-      else MDK_Window[i] += MDK[j];
-    }
-
-    /* Calculate the similiraty value for the i column */
-    MDK_Window[i] = MDK_Window[i] / (float) window;
+    lowerWindow[i] = windowValue(lowerMDK, i);
+    upperWindow[i] = windowValue(upperMDK, i);
+    MDK_Window[i] = windowValue(MDK, i);
   }
   return true;
 }
@@ -258,17 +611,78 @@ bool statisticsConservation::isDefinedWindow(void) {
 }
 
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-|  bool statisticsConservation::getMdkwVector(void)                                                                    |
+|  float *statisticsConservation::getMdkwVector(void)                                                                  |
 |                                                                                                                      |
-|       This method returns a pointer to conservation values' vector.                                                  |
+|     This method returns a pointer to conservation values' vector. Values are estimated when pairs are sampled.       |
 |                                                                                                                      |
 ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 float *statisticsConservation::getMdkwVector(void) {
 
+  if(samples == 0)
+    computeWindows(-HUGE_VALF, HUGE_VALF);
   return MDK_Window;
 }
 
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+|  const float *statisticsConservation::getMdkwVector(float)                                                           |
+|                                                                                                                      |
+|     This method returns a pointer to a conservation values' vector that can only be compared against the given       |
+|     cut point. Windows whose bounds contain the cut point get their exact values while others may keep any value     |
+|     between their bounds, which are at the same side of the cut point than the exact value.                          |
+|                                                                                                                      |
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+const float *statisticsConservation::getMdkwVector(float cut) {
+
+  computeWindows(cut, cut);
+  return MDK_Window;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+|  float statisticsConservation::getMdkwValue(const int *, int, int)                                                   |
+|                                                                                                                      |
+|     This method returns the value at the given position of the sorted conservation values of a set of windows, all   |
+|     of them if it is NULL. That value is between the values at the same position of both sorted bounds, so only      |
+|     windows overlapping that range are computed. Windows with lower values are counted to locate the position.       |
+|                                                                                                                      |
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+float statisticsConservation::getMdkwValue(const int *windows, int count, int position) {
+
+  float lower, upper, value, *values;
+  int i, w, below, candidates, *list;
+
+  values = new float[count];
+  list = new int[count];
+
+  for(i = 0; i < count; i++)
+    values[i] = lowerWindow[(windows == NULL) ? i : windows[i]];
+  utils::quicksort(values, 0, count-1);
+  lower = values[position];
+
+  for(i = 0; i < count; i++)
+    values[i] = upperWindow[(windows == NULL) ? i : windows[i]];
+  utils::quicksort(values, 0, count-1);
+  upper = values[position];
+
+  for(i = 0, below = 0, candidates = 0; i < count; i++) {
+    w = (windows == NULL) ? i : windows[i];
+    if(upperWindow[w] < lower) below++;
+    else if(lowerWindow[w] <= upper) list[candidates++] = w;
+  }
+  computeWindows(list, candidates);
+
+  for(i = 0; i < candidates; i++)
+    values[i] = MDK_Window[list[i]];
+  utils::quicksort(values, 0, candidates-1);
+  value = values[position - below];
+
+  delete [] values;
+  delete [] list;
+  return value;
+}
+
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 |  bool statisticsConservation::setSimilarityMatrix(similarityMatrix *)                                                |
 |                                                                                                                      |
@@ -309,33 +723,46 @@ double statisticsConservation::calcCutPoint(float minInputAlignment,
    * method will select a different cutting-point. */
 
   double cuttingPoint_MinimumConserv, cuttingPoint_SimilThreshold;
-  int i, highestPos;
+  int i, below, highestPos;
   float *vectAux;
 
-  /* Allocate memory */
-  vectAux = new float[columns];
-
-  /* Sort a copy of the vector containing the similarity values after applying
-   * any windows methods. Take the columns value that it lower than the minimum
-   * similarity threshold set by the user */
-  utils::copyVect(MDK_Window, vectAux, columns);
-  utils::quicksort(vectAux, 0, columns-1);
-
-  for(i = columns - 1; i >= 0; i--)
-    if(vectAux[i] < similThreshold)
-      break;
-  cuttingPoint_SimilThreshold = vectAux[i];
-
   /* It is possible that due to number casting, we get a number out of the
    * vector containing the similarity values - it is not reporting an overflow
    * situation but giving back a 0 when it should be a number equal (or closer)
    * to 1. */
   highestPos = (int) ((double)(columns - 1) * (100.0 - minInputAlignment)/100.0);
   highestPos = highestPos < (columns - 1) ? highestPos : columns - 1;
-  cuttingPoint_MinimumConserv = vectAux[highestPos];
 
-  /* Deallocate memory */
-  delete[] vectAux;
+  /* Count the columns whose value is lower than the minimum similarity
+   * threshold set by the user. Only windows whose bounds contain it have to be
+   * computed for that */
+  computeWindows(similThreshold, similThreshold);
+  for(i = 0, below = 0; i < columns; i++)
+    if(upperWindow[i] < similThreshold)
+      below++;
+
+  /* Take the highest value lower than the threshold and the value that keeps
+   * the minimum percentage of columns from the sorted similarity values */
+  if(below > 0) {
+    cuttingPoint_SimilThreshold = getMdkwValue(NULL, columns, below - 1);
+    cuttingPoint_MinimumConserv = getMdkwValue(NULL, columns, highestPos);
+  }
+
+  /* Otherwise, sort a copy of the whole vector containing the similarity
+   * values after applying any windows methods */
+  else {
+    vectAux = new float[columns];
+    utils::copyVect(getMdkwVector(), vectAux, columns);
+    utils::quicksort(vectAux, 0, columns-1);
+
+    for(i = columns - 1; i >= 0; i--)
+      if(vectAux[i] < similThreshold)
+        break;
+    cuttingPoint_SimilThreshold = vectAux[i];
+    cuttingPoint_MinimumConserv = vectAux[highestPos];
+
+    delete[] vectAux;
+  }
 
   /* Return the minimum cutting point between the one set by the threshold and
    * the one set by the minimum percentage of the input alignment to be kept */
@@ -343,10 +770,24 @@ double statisticsConservation::calcCutPoint(float minInputAlignment,
     cuttingPoint_MinimumConserv : cuttingPoint_SimilThreshold);
 }
 
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+|  void statisticsConservation::setSamples(int)                                                                        |
+|                                                                                                                      |
+|       This method sets the number of pairs of residues sampled in each column to estimate its conservation value.    |
+|       Columns whose confidence interval contains a cut point are computed exactly. With 0, every value is exact.     |
+|                                                                                                                      |
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+void statisticsConservation::setSamples(int samples_) {
+
+  samples = samples_;
+}
+
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 |  void statisticsConservation::printConservationColumns(void)                                                         |
 |                                                                                                                      |
-|       This method prints the conservation's value for each column in the alignment.                                  |
+|       This method prints the conservation's value for each column in the alignment. When values are estimated, the   |
+|       confidence interval of each one is printed too. Both bounds are the same for exact values.                     |
 |                                                                                                                      |
 ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
@@ -354,12 +795,28 @@ void statisticsConservation::printConservationColumns(void) {
 
   int i;
 
+  /* Estimated values are printed with their confidence intervals */
+  if(samples > 0) {
+    cout << "| Residue\t Similarity  \t     Confidence Interval     |" << endl;
+    cout << "| Number \t    Value    \t    Lower     \t    Upper     |" << endl;
+    cout << "+------------------------------------------------------------+" << endl;
+    cout.precision(10);
+
+    for(i = 0; i < columns; i++)
+      cout << "  " << setw(5) << i << "\t\t" << setw(7) << MDK_Window[i] << "\t" << setw(12) << lowerWindow[i]
+           << "\t" << setw(12) << upperWindow[i] << endl;
+    return;
+  }
+
   /* We set the output precision and print the header. */
   cout << "| Residue\t Similarity  |" << endl;
   cout << "| Number \t    Value    |" << endl;
   cout << "+----------------------------+" << endl;
   cout.precision(10);
 
+  /* Every value is printed, so all of them should be known */
+  getMdkwVector();
+
   /* If MDK_Window vector is defined, we use it to print the conservation's values. */
   if(MDK_Window != NULL)
     for(i = 0; i < columns; i++)
@@ -387,7 +844,7 @@ void statisticsConservation::printConservationAcl(void) {
   vectAux = new float[columns];
 
   /* Select the conservation's value source and copy that vector in a auxiliar vector */
-  if(MDK_Window != NULL) utils::copyVect(MDK_Window, vectAux, columns);
+  if(MDK_Window != NULL) utils::copyVect(getMdkwVector(), vectAux, columns);
   else utils::copyVect(MDK, vectAux, columns);
 
   /* Sort the auxiliar vector. */
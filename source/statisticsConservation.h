@@ -28,11 +28,14 @@
 #define STATISTICS_CONSERVATION_H
 
 #include <math.h>
+#include <float.h>
 #include <iostream>
 #include <iomanip>
 
 #include "similarityMatrix.h"
+#include "identityMatrix.h"
 #include "statisticsGaps.h"
+#include "threadPool.h"
 #include "defines.h"
 #include "utils.h"
 
@@ -42,6 +45,16 @@ using namespace std;
 /*                                       Header Class File: StatisticsConservation.                                  */
 /* ***************************************************************************************************************** */
 
+class statisticsConservation;
+
+/* Columns computed by the tasks computing the conservation values. Without
+ * a list, every column is computed */
+struct conservationJob {
+  statisticsConservation *object;
+  const int *list;
+  int count;
+};
+
 class statisticsConservation{
  private:
 
@@ -56,19 +69,64 @@ class statisticsConservation{
   int halfWindow;
 
   /* Conservation vectors */
-  float *Q;
   float *MDK;
   float *MDK_Window;
 
-  /* Identity weight matrix between alignment rows */
-  float **matrixIdentity;
+  /* Bounds of the conservation values for each column and window. A value is
+   * known once both bounds are the same. Otherwise, values are within their
+   * bounds: lower bounds or, for sampled columns, their estimates */
+  float *lowerMDK;
+  float *upperMDK;
+  float *lowerWindow;
+  float *upperWindow;
+
+  /* Residues codes stored column by column and gaps per column, both kept by
+   * the alignment, and distances between codes. They are used to compute the
+   * conservation values when they are needed */
+  const unsigned char *codes;
+  const int *gaps;
+  float *distances;
+  int alphabetSize;
+
+  /* Identities between alignment rows, owned by the alignment. Pairs are
+   * weighted by their distance, i.e. 100 minus their identity percentage */
+  const identityMatrix *identities;
+
+  /* Unique sequence of each sequence when pairs of its copies have a null
+   * weight, so they are skipped, and a different negative value otherwise */
+  int *copies;
+
+  /* First column with the same residues and gaps than each column, whose
+   * values are computed once and copied to the others */
+  int *sameColumn;
 
   /* Similarity matrix used to conservation calculations */
   similarityMatrix *simMatrix;
 
-  /* Private methods */
-  /* Computes the matrix identity between alignment's columns. */
-  void calculateMatrixIdentity(string *alignmentMatrix);
+  /* Pairs of residues sampled to estimate the conservation value of each
+   * column. Exact values are computed when it is 0 */
+  static int samples;
+
+  /* Computes the conservation values bounds for a block of columns */
+  static void boundsTask(int, void *);
+
+  /* Computes the conservation values for a block of the listed columns */
+  static void conservationTask(int, void *);
+
+  /* Exact conservation value of a column from its sequences with a valid residue */
+  float columnValue(const unsigned char *, const int *, int);
+
+  /* Narrows the bounds of a column to the confidence interval estimated from a sample of its pairs */
+  void estimateColumn(int, const unsigned char *, const int *, int);
+
+  /* Average of the given values over a window */
+  float windowValue(const float *, int);
+
+  /* Computes the exact values of the given windows */
+  void computeWindows(const int *, int);
+
+  /* Computes the exact values of the windows that may be in the given range */
+  void computeWindows(float, float);
 
  public:
 
@@ -76,13 +134,13 @@ class statisticsConservation{
   statisticsConservation(void);
 
   /* Constructors using parameters */
-  statisticsConservation(string *, int, int, int);
+  statisticsConservation(const identityMatrix *, int, int, int);
 
   /* Destroyer */
   ~statisticsConservation(void);
 
   /* This methods allows us compute the alignment's conservation's values. */
-  bool calculateVectors(string *, int *);
+  bool calculateVectors(const unsigned char *, const char *, int, int *, const int *, int, const int *, const int *);
 
   /* Allows us compute the conservationWindow's values. */
   bool applyWindow(int);
@@ -93,6 +151,12 @@ class statisticsConservation{
   /* This methods returns a pointer to conservationWindow's vector */
   float *getMdkwVector(void);
 
+  /* Returns a pointer to conservationWindow's vector only valid to be compared against the given value */
+  const float *getMdkwVector(float);
+
+  /* Returns the value at the given position of the sorted conservationWindow's values for a set of windows */
+  float getMdkwValue(const int *, int, int);
+
   /* Associates a pointer to similarity matrix. This matrix is needed to compute the conservation's values. */
   bool setSimilarityMatrix(similarityMatrix *);
 
@@ -102,6 +166,9 @@ class statisticsConservation{
   /* Computes and selects the cut point values based on conservation's values. */
   double calcCutPoint(float, float);
 
+  /* Estimates conservation values from the given number of pairs of residues per column, 0 to compute them */
+  static void setSamples(int);
+
   /* Prints the conservation's value for each alignment's column. */
   void printConservationColumns(void);
 
@@ -27,17 +27,16 @@
 #include "statisticsGaps.h"
 
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-|  statisticsGaps::statisticsGaps(char **, int, int)                                                                   |
+|  statisticsGaps::statisticsGaps(int *, int *, int, int, int)                                                         |
 |                                                                                                                      |
-|       Class constructor. This method uses the inputs parameters to put the information in the new object that        |
-|       has been created.                                                                                              |
+|       Class constructor. Gaps and indeterminations per column have been already counted, either from the alignment   |
+|       bit masks or loaded from a binary alignment, so the alignment itself is not needed.                            |
 |                                                                                                                      |
 ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
-statisticsGaps::statisticsGaps(string *alignmentMatrix, int species, int aminos, int dataType_) {
+statisticsGaps::statisticsGaps(int *gaps, int *indets, int species, int aminos, int dataType_) {
 
-  int i, j;
-  char indet;
+  int i;
 
   columnLength = species;
   columns =      aminos;
@@ -45,34 +44,19 @@ statisticsGaps::statisticsGaps(string *alignmentMatrix, int species, int aminos,
   halfWindow =   0;
   dataType = dataType_;
 
-  if(dataType == AAType)
-    indet = 'X';
-  else
-    indet = 'N';
-
   /* Memory allocation for the vectors and its initialization */
   gapsInColumn =       new int[columns];
-  utils::initlVect(gapsInColumn, columns, 0);
-
   aminosXInColumn =    new int[columns];
-  utils::initlVect(aminosXInColumn, aminos, 0);
-
   gapsWindow =         new int[columns];
-  utils::initlVect(gapsWindow, columns, 0);
 
   numColumnsWithGaps = new int[species+1];
   utils::initlVect(numColumnsWithGaps, columnLength+1, 0);
 
-  /* Count the gaps and indeterminations of each columns */
   for(i = 0; i < columns; i++) {
-    for(j = 0; j < columnLength; j++) {
-      if(alignmentMatrix[j][i] == '-')
-        gapsInColumn[i]++;
-      else if(alignmentMatrix[j][i] == indet)
-        aminosXInColumn[i]++;
-    }
+    gapsInColumn[i] = gaps[i];
+    aminosXInColumn[i] = indets[i];
 
-    /* Increase the number of colums with the number of gaps of the last processed column */
+    /* Increase the number of colums with the number of gaps of the current column */
     numColumnsWithGaps[gapsInColumn[i]]++;
     gapsWindow[i] = gapsInColumn[i];
     if(gapsWindow[i] > maxGaps) maxGaps = gapsWindow[i];
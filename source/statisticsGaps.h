@@ -59,8 +59,8 @@ class statisticsGaps {
   /* Class destroyer. */
   ~statisticsGaps(void);
 
-  /* Class constructor with parameters. */
-  statisticsGaps(string *, int, int, int);
+  /* Class constructor from gaps and indeterminations already counted. */
+  statisticsGaps(int *, int *, int, int, int);
 
   /* Methods allows us compute the gapWindows' values. */
   bool applyWindow(int);
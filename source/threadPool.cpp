@@ -0,0 +1,156 @@
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+   ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+
+    trimAl v1.4: a tool for automated alignment trimming in large-scale
+                 phylogenetics analyses.
+
+    2009-2015 Capella-Gutierrez S. and Gabaldon, T.
+              [scapella, tgabaldon]@crg.es
+
+    This file is part of trimAl
+
+    trimAl is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, the last available version.
+
+    trimAl is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with trimAl. If not, see <http://www.gnu.org/licenses/>.
+
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+
+#include "threadPool.h"
+
+static mutex sharedLock;
+static threadPool *sharedPool = NULL;
+static int sharedThreads = 0;
+
+threadPool::threadPool(int threads_) {
+  int i;
+
+  threads = (threads_ < 1) ? 1 : threads_;
+
+  function = NULL;
+  argument = NULL;
+  tasks = 0;
+  nextTask = 0;
+  pendingTasks = 0;
+  stopping = false;
+
+  /* Calling thread is used as a worker when a job is run */
+  workers = NULL;
+  if(threads > 1) {
+    workers = new thread[threads - 1];
+    for(i = 0; i < threads - 1; i++)
+      workers[i] = thread(&threadPool::work, this);
+  }
+}
+
+threadPool::~threadPool(void) {
+  int i;
+
+  {
+    lock_guard<mutex> guard(lock);
+    stopping = true;
+  }
+  wake.notify_all();
+
+  for(i = 0; i < threads - 1; i++)
+    workers[i].join();
+  delete [] workers;
+}
+
+int threadPool::getThreads(void) {
+  return threads;
+}
+
+void threadPool::runTasks(unique_lock<mutex> &guard) {
+  /* Take tasks one by one. Lock is released while a task runs */
+  int task;
+
+  while(nextTask < tasks) {
+    task = nextTask++;
+    guard.unlock();
+    function(task, argument);
+    guard.lock();
+
+    if(--pendingTasks == 0)
+      finished.notify_all();
+  }
+}
+
+void threadPool::work(void) {
+  unique_lock<mutex> guard(lock);
+
+  while(true) {
+    wake.wait(guard, [this] { return stopping || (nextTask < tasks); });
+    if(stopping)
+      break;
+    runTasks(guard);
+  }
+}
+
+void threadPool::run(int tasks_, void (*function_)(int, void *),
+  void *argument_) {
+  int i;
+
+  /* Single tasks, single threaded pools and nested calls do not need any
+   * other thread */
+  if((tasks_ < 2) || (threads < 2) || (!busy.try_lock())) {
+    for(i = 0; i < tasks_; i++)
+      function_(i, argument_);
+    return;
+  }
+
+  unique_lock<mutex> guard(lock);
+  function = function_;
+  argument = argument_;
+  tasks = tasks_;
+  nextTask = 0;
+  pendingTasks = tasks_;
+  wake.notify_all();
+
+  runTasks(guard);
+  finished.wait(guard, [this] { return pendingTasks == 0; });
+
+  function = NULL;
+  argument = NULL;
+  tasks = 0;
+  nextTask = 0;
+  guard.unlock();
+
+  busy.unlock();
+}
+
+threadPool *threadPool::getShared(void) {
+  lock_guard<mutex> guard(sharedLock);
+
+  if(sharedPool == NULL) {
+    if(sharedThreads < 1)
+      sharedThreads = thread::hardware_concurrency();
+    sharedPool = new threadPool(sharedThreads);
+  }
+  return sharedPool;
+}
+
+void threadPool::runShared(int tasks_, void (*function_)(int, void *),
+  void *argument_) {
+
+  if(tasks_ == 1)
+    function_(0, argument_);
+  else if(tasks_ > 1)
+    getShared() -> run(tasks_, function_, argument_);
+}
+
+void threadPool::setSharedThreads(int threads_) {
+  lock_guard<mutex> guard(sharedLock);
+
+  /* It only has effect before the shared pool is created */
+  if(sharedPool == NULL)
+    sharedThreads = threads_;
+}
@@ -0,0 +1,95 @@
+/* ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+   ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+
+    trimAl v1.4: a tool for automated alignment trimming in large-scale
+                 phylogenetics analyses.
+
+    2009-2015 Capella-Gutierrez S. and Gabaldon, T.
+              [scapella, tgabaldon]@crg.es
+
+    This file is part of trimAl
+
+    trimAl is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, the last available version.
+
+    trimAl is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with trimAl. If not, see <http://www.gnu.org/licenses/>.
+
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** *****
+***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** ***** */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+/* ***************************************************************************************************************** */
+/*                                           Header Class File: threadPool.                                          */
+/* ***************************************************************************************************************** */
+
+/* Fixed set of worker threads running independent tasks. A job is made of a
+ * number of tasks identified by its index. The calling thread works on them
+ * too and waits until all of them are done. If the pool is already running
+ * a job, e.g. a nested call from one of its tasks, the new job is executed
+ * by the calling thread alone */
+
+class threadPool {
+
+  int threads;
+  thread *workers;
+
+  mutex lock;
+  mutex busy;
+  condition_variable wake;
+  condition_variable finished;
+
+  /* Current job */
+  void (*function)(int, void *);
+  void *argument;
+  int tasks;
+  int nextTask;
+  int pendingTasks;
+  bool stopping;
+
+  /* Worker threads main loop */
+  void work(void);
+
+  /* Run tasks from current job while there are any left */
+  void runTasks(unique_lock<mutex> &);
+
+ public:
+
+  /* Class constructor. Calling thread is counted as one of the threads */
+  threadPool(int);
+
+  /* Class destroyer. */
+  ~threadPool(void);
+
+  /* Number of threads running tasks */
+  int getThreads(void);
+
+  /* Run the given function for every task index and wait for all of them */
+  void run(int, void (*)(int, void *), void *);
+
+  /* Pool shared by the whole program */
+  static threadPool *getShared(void);
+
+  /* Run a job on the shared pool. Single tasks jobs are run directly
+   * without creating the pool */
+  static void runShared(int, void (*)(int, void *), void *);
+
+  /* Set the number of threads for the shared pool before it is used. By
+   * default, it uses as many threads as hardware cores */
+  static void setSharedThreads(int);
+};
+#endif
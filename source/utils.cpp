@@ -49,6 +49,37 @@ void utils::initlVect(float *vector, int tam, float valor) {
 
 }
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++
+| int utils::countBits(const uint64_t *, int)     |
+|      These methods count the bits set in a bit  |
+|      mask, in the intersection of two masks or  |
+|      in their union.                            |
++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+int utils::countBits(const uint64_t *mask, int words) {
+  int i, bits;
+
+  for(i = 0, bits = 0; i < words; i++)
+    bits += __builtin_popcountll(mask[i]);
+  return bits;
+}
+
+int utils::countCommonBits(const uint64_t *mask, const uint64_t *other, int words) {
+  int i, bits;
+
+  for(i = 0, bits = 0; i < words; i++)
+    bits += __builtin_popcountll(mask[i] & other[i]);
+  return bits;
+}
+
+int utils::countAnyBits(const uint64_t *mask, const uint64_t *other, int words) {
+  int i, bits;
+
+  for(i = 0, bits = 0; i < words; i++)
+    bits += __builtin_popcountll(mask[i] | other[i]);
+  return bits;
+}
+
 
 /*+++++++++++++++++++++++++++++++++++++++++++++
 | void utils::copyVect(int *, int *, int)     |
@@ -386,77 +417,13 @@ void utils::swap(int **a, int **b){
  *
  * ************************************************************************** */
 
-bool utils::checkFile(ifstream &file) {
-  /* Check if a given file exists and its size is greater than 0 */
-  long begin, end;
-
-  /* Check whether input file exists or not */
-  if(!file)
-    return false;
-
-  /* Check input file sizes. A valid file should have a size grater than 0 */
-  begin = file.tellg();
-  file.seekg(0, ios::end);
-  end = file.tellg();
-  file.seekg(0, ios::beg);
-  /* Compare difference between file start and end.
-   * Depending on result, return True or False */
-  if(!(end - begin))
-    return false;
-  return true;
-}
-
-char* utils::readLine(ifstream &file) {
-  /* Read a new line from current input stream. This function is better than
-   * standard one since cares of operative system compability. It is useful
-   * as well because remove tabs and blank spaces at lines beginning/ending */
-
-  int state;
-  char c = ' ';
-  string nline;
-  static char *line = NULL;
-
-  /* Check it the end of the file has been reached or not */
-  if(file.eof())
-    return NULL;
-
-  /* Store first line found. For -Windows & MacOS compatibility- carriage return
-   * is considered as well as a new line character */
-      for( ; (c != '\n') && ((!file.eof())); file.read(&c, 1))
-        if ((c != '\r'))
-            nline.resize(nline.size() + 1, c);
-
-  /* Remove blank spaces & tabs from the beginning of the line */
-  state = nline.find(" ", 0);
-  while(state != (int) string::npos && state == 0) {
-    nline.erase(state, 1);
-    state = nline.find(" ", state);
-  }
-
-  state = nline.find("\t", 0);
-  while(state != (int) string::npos && state == 0) {
-    nline.erase(state, 1);
-    state = nline.find("\t", state);
-  }
-
-  /* If there is nothing to return, give back a NULL pointer ... */
-  if(nline.size() == 0)
-    return NULL;
-
-  /* Otherwise, initialize the appropiate data structure,
-   * dump the data and return it */
-  line = new char[nline.size() + 1];
-  strcpy(line, nline.c_str());
-  return line;
-}
-
 char* utils::trimLine(string nline) {
   /* This function is used to remove comments inbetween a biological sequence.
    * Remove all content surrounded by ("") or ([]). It wans as well when a
    * mismatch for these flags is found */
 
   int pos, next;
-  static char *line;
+  char *line;
 
   /* Set-up lower and upper limit to look for comments inside of input string */
   pos = -1;
@@ -638,7 +605,7 @@ int utils::checkTypeAlignment(int seqNumber, int residNumber, string *sequences)
 int* utils::readNumbers_StartEnd(string line) {
 
   int comma, nElems = 0;
-  static int *numbers;
+  int *numbers;
 
  comma = -1;
   while((comma = line.find(",", comma + 1)) != (int) string::npos)
@@ -660,7 +627,7 @@ int* utils::readNumbers_StartEnd(string line) {
 int* utils::readNumbers(string line) {
 
   int i, comma, separ, init, nElems = 0;
-  static int *numbers;
+  int *numbers;
 
   /* ***** ***** ***** ***** ***** ***** ***** ***** */
  comma = -1;
@@ -32,6 +32,7 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
 
 #include <fstream>
 #include <iostream>
@@ -56,6 +57,18 @@ class utils {
   static void initlVect(int *vector, int tam, int valor);
   static void initlVect(float *vector, int tam, float valor);
 
+  /** \brief Bit masks counting.
+   * \param mask Bit mask stored as 64-bit words.
+   * \param other Second bit mask with the same number of words.
+   * \param words Number of words in the masks.
+   * \return Number of bits set in \b mask, in both masks or in any of them.
+   *
+   * These methods count set bits word by word using the processor population count.
+   */
+  static int countBits(const uint64_t *mask, int words);
+  static int countCommonBits(const uint64_t *mask, const uint64_t *other, int words);
+  static int countAnyBits(const uint64_t *mask, const uint64_t *other, int words);
+
   /** \brief Integer vector copying.
    * \param vect1 Vector that we want to copy.
    * \param vect2 Destination vector of the copy.
@@ -177,10 +190,6 @@ class utils {
    */
   static void swap(int *a, int *b);
 
-  static bool checkFile(ifstream &file);
-
-  static char* readLine(ifstream &file);
-
   static char* trimLine(string nline);
 
   static char* readLineMEGA(ifstream &file);
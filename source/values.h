@@ -27,11 +27,11 @@
 #ifdef SIMMatrix
 
 /* Characters used for different alignments type */
-char listNTSym[6] = "ACGTU";
+constexpr char listNTSym[6] = "ACGTU";
 
-char listAASym[21] = "ARNDCQEGHILKMFPSTWYV";
+constexpr char listAASym[21] = "ARNDCQEGHILKMFPSTWYV";
 
-char listNTDegenerateSym[16] = "ACGTURYKMSWBDHV";
+constexpr char listNTDegenerateSym[16] = "ACGTURYKMSWBDHV";
 
 /* Characters used to indicate indeterminations */
 char protein_wildcards[3] = "BX";
@@ -41,7 +41,7 @@ char protein_wildcards[3] = "BX";
 char protein_alternative_aminoacids[3] = "UO";
 
 /* Default Identity Matrix for Canonical Nucleotides */
-float defaultNTMatrix[5][5] = {
+constexpr float defaultNTMatrix[5][5] = {
   {1, 0, 0, 0, 0},
   {0, 1, 0, 0, 0},
   {0, 0, 1, 0, 0},
@@ -49,7 +49,7 @@ float defaultNTMatrix[5][5] = {
   {0, 0, 0, 0, 1}
 };
 
-float defaultNTDegeneratedMatrix[15][15] = {
+constexpr float defaultNTDegeneratedMatrix[15][15] = {
 /* A: adenosine (A)        C: cytidine   (C)            G: guanine (G)            T: thymidine  (T)           U: uridine    (U)
  * R: purine    (G | A)    Y: pyrimidine (C | T/u)      K: keto    (G | T/u)      M: amino      (A | C)       S: strong     (G | C)
  * W: weak      (A | T/u)  B: not A      (G | C | T/u)  D: not C   (G | A | T/u)  H: not G      (A | C | T/u) V: not T/u    (G | C | A) */
@@ -71,7 +71,7 @@ float defaultNTDegeneratedMatrix[15][15] = {
 };
 
 /* BLOSUM62 Similarity Matrix */
-float defaultAAMatrix[20][20] = {
+constexpr float defaultAAMatrix[20][20] = {
   {  4, -1, -2, -2,  0, -1, -1,  0, -2, -1, -1, -1, -1, -2, -1,  1,  0, -3, -2,  0},
   { -1,  5,  0, -2, -3,  1,  0, -2,  0, -3, -2,  2, -1, -3, -2, -1, -1, -3, -2, -3},
   { -2,  0,  6,  1, -3,  0,  0,  0,  1, -3, -3,  0, -2, -3, -2,  1,  0, -4, -2, -3},
@@ -98,7 +98,7 @@ float defaultAAMatrix[20][20] = {
 /* Alternative matrixes */
 
 // Nucleotides
-float alternative_1_NTDegeneratedMatrix[15][15] = {
+constexpr float alternative_1_NTDegeneratedMatrix[15][15] = {
   { 1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0},
   { 0,  1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0},
   { 0,  0,  1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0},